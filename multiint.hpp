@@ -31,15 +31,118 @@ SOFTWARE.
 #include <stdexcept>
 #include <iostream>
 #include <sstream>
+#include <iomanip>
 #include <cstdlib>
+#include <cmath>
 #include <cassert>
+#include <type_traits>
+#include <vector>
+#include <thread>
+#include <exception>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <memory>
 
 #define CPP11VERSION 199711L
+#define CPP14VERSION 201402L
 
 #ifdef __SIZEOF_INT128__
 #define USE_NATIVE_INT128
 #endif
 
+/* With C++14 relaxed constexpr rules, most of the operations can be
+ * evaluated at compile time so large constants do not need any runtime
+ * construction. This needs the native 128 bits type.
+ */
+#if __cplusplus >= CPP14VERSION && defined( USE_NATIVE_INT128 )
+#define MULTIINT_HAS_CONSTEXPR
+#define MULTIINT_CONSTEXPR constexpr
+#else
+#define MULTIINT_CONSTEXPR
+#endif
+
+/* Kernels that cannot be evaluated at compile time are only enabled when
+ * constant evaluation can be detected.
+ */
+#if !defined( MULTIINT_HAS_CONSTEXPR )
+#define MULTIINT_IS_CONSTANT_EVALUATED() false
+#elif defined( __has_builtin )
+#if __has_builtin( __builtin_is_constant_evaluated )
+#define MULTIINT_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#endif
+#endif
+
+/* Wide integers use explicit SIMD kernels on x86 with gcc and clang. The
+ * instruction set is selected at run time, with a scalar fallback. Define
+ * MULTIINT_NO_SIMD to disable them and MULTIINT_SIMD_THRESHOLD to change the
+ * number of limbs from which they are used.
+ */
+#if defined( __GNUC__ ) && ( defined( __x86_64__ ) || defined( __i386__ ) ) && !defined( MULTIINT_NO_SIMD ) && defined( MULTIINT_IS_CONSTANT_EVALUATED )
+#define MULTIINT_SIMD
+#endif
+
+#ifdef MULTIINT_SIMD
+#include <immintrin.h>
+#ifndef MULTIINT_SIMD_THRESHOLD
+#define MULTIINT_SIMD_THRESHOLD 16
+#endif
+#endif
+
+/* Products of operands of at least MULTIINT_NTT_THRESHOLD limbs each use
+ * number theoretic transforms instead of the schoolbook product, twice as
+ * many for the truncated products of the operators. Divisions where both
+ * the divisor and the quotient have at least MULTIINT_NEWTON_THRESHOLD
+ * limbs then multiply by a reciprocal computed by Newton's iteration.
+ * Define MULTIINT_NO_NTT to disable both.
+ */
+#if defined( MULTIINT_IS_CONSTANT_EVALUATED ) && !defined( MULTIINT_NO_NTT )
+#define MULTIINT_NTT
+#ifndef MULTIINT_NTT_THRESHOLD
+#define MULTIINT_NTT_THRESHOLD 448
+#endif
+#ifndef MULTIINT_NEWTON_THRESHOLD
+#define MULTIINT_NEWTON_THRESHOLD 1536
+#endif
+#endif
+
+/* Default number of limbs of both operands from which the products can use
+ * several threads, see setMultiplicationThreads.
+ */
+#ifndef MULTIINT_NTT_PARALLEL_THRESHOLD
+#define MULTIINT_NTT_PARALLEL_THRESHOLD 4096
+#endif
+
+/* Default number of values below which the transforms of these products are
+ * not split further between threads.
+ */
+#ifndef MULTIINT_NTT_FORK_SIZE
+#define MULTIINT_NTT_FORK_SIZE 8192
+#endif
+
+#if defined( __cpp_impl_three_way_comparison ) && __cpp_impl_three_way_comparison >= 201907L
+#include <compare>
+#define MULTIINT_HAS_THREE_WAY_COMPARISON
+#endif
+
+/* std::pmr memory resources can provide the limbs of DynamicLargeInteger,
+ * see PmrDynamicLargeInteger.
+ */
+#if __cplusplus >= 201703L && defined( __has_include )
+#if __has_include( <memory_resource> )
+#include <memory_resource>
+#define MULTIINT_HAS_PMR
+#endif
+#endif
+
+/* Number of limbs, 1 MiB by default, that the pool of each thread keeps for
+ * the next DynamicLargeInteger values once they have been freed.
+ */
+#ifndef MULTIINT_LIMB_POOL_LIMBS
+#define MULTIINT_LIMB_POOL_LIMBS ( 1 << 17 )
+#endif
+
 #ifdef USE_NATIVE_INT128
 typedef unsigned __int128 uint128_t;
 #else
@@ -95,17 +198,8 @@ class Basic128
    
    int64_t operator/( uint64_t i ) const
      {
-        Basic128 res( 0 );
-        uint64_t r = 0;
-        
-        for( int k = 0; k < 4; ++k )
-          {
-             r = r << 32 | (uint64_t)num[k];
-             res.num[k] = r / i;
-             r %= i;
-          }
-        
-        return ( (uint64_t)res.num[ 2 ] << 32 ) | res.num[ 3 ];
+        uint64_t r;
+        return divide( i, r );
      }
    
    uint64_t operator&( uint64_t i ) const
@@ -150,22 +244,55 @@ class Basic128
    
    Basic128 operator%=( uint64_t i )
      {
-        uint64_t r = 0;
+        uint64_t r;
+        divide( i, r );
+        *this = Basic128( r );
+        return *this;
+     }
+   
+ private:
+   /* Returns the low 64 bits of the quotient by i and stores the remainder
+    * in r. The divisor is normalized and the two 32 bits digits of the
+    * quotient are estimated from its top half, then corrected (Hacker's
+    * Delight, divlu).
+    */
+   uint64_t divide( uint64_t i, uint64_t& r ) const
+     {
+        if( i == 0 ) throw std::invalid_argument( "Division by zero" );
         
-        for( int k = 0; k < 4; ++k )
+        uint64_t hi = ( (uint64_t)num[ 0 ] << 32 ) | num[ 1 ];
+        uint64_t lo = ( (uint64_t)num[ 2 ] << 32 ) | num[ 3 ];
+        int s = 0;
+        while( !( ( i << s ) >> 63 ) ) ++s;
+        uint64_t d = i << s;
+        uint64_t d1 = d >> 32;
+        uint64_t d0 = d & 0xFFFFFFFF;
+        uint64_t u1 = hi % i;
+        if( s ) u1 = ( u1 << s ) | ( lo >> ( 64 - s ) );
+        uint64_t u0 = lo << s;
+        
+        uint64_t q1 = u1 / d1;
+        uint64_t rhat = u1 - q1 * d1;
+        while( ( q1 >> 32 ) || q1 * d0 > ( ( rhat << 32 ) | ( u0 >> 32 ) ) )
           {
-             r = r << 32 | num[ k ];
-             r %= i;
+             --q1;
+             rhat += d1;
+             if( rhat >> 32 ) break;
           }
+        uint64_t u21 = ( u1 << 32 ) + ( u0 >> 32 ) - q1 * d;
         
-        num[ 0 ] = 0;
-        num[ 1 ] = 0;
-        num[ 2 ] = r >> 32;
-        num[ 3 ] = r & 0xFFFFFFFF;
-        return *this;
+        uint64_t q0 = u21 / d1;
+        rhat = u21 - q0 * d1;
+        while( ( q0 >> 32 ) || q0 * d0 > ( ( rhat << 32 ) | ( u0 & 0xFFFFFFFF ) ) )
+          {
+             --q0;
+             rhat += d1;
+             if( rhat >> 32 ) break;
+          }
+        r = ( ( u21 << 32 ) + ( u0 & 0xFFFFFFFF ) - q0 * d ) >> s;
+        return ( q1 << 32 ) | q0;
      }
    
- private:
    uint32_t num[ 4 ];
 };
 
@@ -181,1164 +308,5400 @@ class number_format_error : public std::runtime_error
        }
 };
 
-/* This will generate an error at compilation time if the user try to
- * define a LargeInteger with a length that is not a multiple of 64.
- * This restriction is required as our integer are compound of 64 bits
- * integers. Moreover, supporting all length would add a lot of complexity
- * with possible performance impact. It should not be a big deal as we are
- * supposed to handle large numbers so a few bits more of less should not make
- * any difference :-)
+/* Thrown when asking for the inverse of a value that is not coprime with
+ * the modulus.
  */
-template< int R > class IntegerWidthShouldBeMultipleOf64;
-
-template<> class IntegerWidthShouldBeMultipleOf64< 0 >
+class not_invertible_error : public std::runtime_error
 {
+ public:
+   not_invertible_error( const std::string& reason )
+     : std::runtime_error( reason )
+       {
+       }
 };
 
-template< int W, typename u128 = uint128_t > class LargeInteger : private IntegerWidthShouldBeMultipleOf64< W & 0x3F >
+/* Low level routines working on raw arrays of 64 bits limbs. The limbs are
+ * stored the same way as in LargeInteger: most significant limb first, so
+ * the least significant limb of an array of n limbs is at index n-1. These
+ * routines make a single pass over the limbs and never allocate.
+ */
+namespace multiint_detail
 {
- private:
-   static const int L = W / 64;
-   
- public:
-   LargeInteger( int64_t i ) : r( NULL )
+   /* res = a * k + c where c is a single limb. Returns the carry out of the
+    * most significant limb. res may be the same array as a.
+    */
+   MULTIINT_CONSTEXPR inline uint64_t muladd_1( uint64_t* res, const uint64_t* a, uint64_t k, uint64_t c, int n )
      {
-        assign( i );
+        uint64_t carry = c;
+        for( int i = n-1; i >= 0; --i )
+          {
+             uint128_t tmp = (uint128_t)a[ i ] * (uint128_t)k + (uint128_t)carry;
+             carry = tmp >> 64;
+             res[ i ] = tmp & 0xFFFFFFFFFFFFFFFFULL;
+          }
+        return carry;
      }
-   
-   LargeInteger( uint64_t i ) : r( NULL )
+
+   /* res = b + a * k. Returns the carry out of the most significant limb.
+    * res may be the same array as a or b.
+    */
+   MULTIINT_CONSTEXPR inline uint64_t addmul_1( uint64_t* res, const uint64_t* a, uint64_t k, const uint64_t* b, int n )
      {
-        assign( i );
+        uint64_t carry = 0;
+        for( int i = n-1; i >= 0; --i )
+          {
+             uint128_t tmp = (uint128_t)a[ i ] * (uint128_t)k + (uint128_t)b[ i ] + (uint128_t)carry;
+             carry = tmp >> 64;
+             res[ i ] = tmp & 0xFFFFFFFFFFFFFFFFULL;
+          }
+        return carry;
      }
-   
-   LargeInteger( int32_t i ) : r( NULL )
+
+   /* res = b - a * k. Returns the borrow out of the most significant limb.
+    * res may be the same array as a or b.
+    */
+   MULTIINT_CONSTEXPR inline uint64_t submul_1( uint64_t* res, const uint64_t* a, uint64_t k, const uint64_t* b, int n )
      {
-        assign( (int64_t)i );
+        uint64_t borrow = 0;
+        for( int i = n-1; i >= 0; --i )
+          {
+             uint128_t tmp = (uint128_t)a[ i ] * (uint128_t)k + (uint128_t)borrow;
+             uint64_t lo = tmp & 0xFFFFFFFFFFFFFFFFULL;
+             borrow = tmp >> 64;
+             uint64_t bi = b[ i ];
+             res[ i ] = bi - lo;
+             if( bi < lo ) ++borrow;
+          }
+        return borrow;
+     }
+
+   /* res = ( x << s ) | y where s can be any shift between 0 and 64*n. The
+    * limbs are produced in a single pass, from the most significant one, so
+    * res may be the same array as x or y.
+    */
+   MULTIINT_CONSTEXPR inline void lshift_or( uint64_t* res, const uint64_t* x, int s, const uint64_t* y, int n )
+     {
+        int offset = s / 64;
+        int b = s % 64;
+        for( int i = 0; i < n; ++i )
+          {
+             int src = i + offset;
+             uint64_t hi = src < n ? x[ src ] : 0;
+             uint64_t lo = src + 1 < n ? x[ src + 1 ] : 0;
+             uint64_t v = b ? ( hi << b ) | ( lo >> ( 64 - b ) ) : hi;
+             res[ i ] = v | ( y ? y[ i ] : 0 );
+          }
+     }
+
+   /* res = x >> s where s can be any shift between 0 and 64*n, the vacated
+    * limbs being filled with fill (0 or ~0 for an arithmetic shift). The
+    * limbs are produced in a single pass, from the least significant one, so
+    * res may be the same array as x.
+    */
+   MULTIINT_CONSTEXPR inline void rshift_fill( uint64_t* res, const uint64_t* x, int s, uint64_t fill, int n )
+     {
+        int offset = s / 64;
+        int b = s % 64;
+        for( int i = n-1; i >= 0; --i )
+          {
+             int src = i - offset;
+             uint64_t lo = src >= 0 ? x[ src ] : fill;
+             if( b )
+               {
+                  uint64_t hi = src >= 1 ? x[ src - 1 ] : fill;
+                  lo = ( lo >> b ) | ( hi << ( 64 - b ) );
+               }
+             res[ i ] = lo;
+          }
      }
    
-   LargeInteger( uint32_t i ) : r( NULL )
+   /* q = a / d, returns a % d. q may be the same array as a. */
+   MULTIINT_CONSTEXPR inline uint64_t divrem_1( uint64_t* q, const uint64_t* a, uint64_t d, int n )
      {
-        assign( (uint64_t)i );
+        uint128_t r( 0 );
+        for( int i = 0; i < n; ++i )
+          {
+             r = (uint128_t)r << 64 | (uint128_t)a[ i ];
+             q[ i ] = r / d;
+             r %= d;
+          }
+        return r & 0xFFFFFFFFFFFFFFFFULL;
      }
-   
-   LargeInteger( int16_t i ) : r( NULL )
+
+   /* Number of leading zero bits of a non zero limb. */
+   constexpr int clz_1( uint64_t x )
      {
-        assign( (int64_t)i );
+#ifdef __GNUC__
+        return __builtin_clzll( x );
+#else
+        return ( x & ( 1ULL << 63 ) ) ? 0 : 1 + clz_1( x << 1 );
+#endif
      }
    
-   LargeInteger( uint16_t i ) : r( NULL )
+   /* Number of trailing zero bits of a non zero limb. */
+   constexpr int ctz_1( uint64_t x )
      {
-        assign( (uint64_t)i );
+#ifdef __GNUC__
+        return __builtin_ctzll( x );
+#else
+        return ( x & 1 ) ? 0 : 1 + ctz_1( x >> 1 );
+#endif
      }
    
-   LargeInteger( int8_t i ) : r( NULL )
+   /* Number of bits set in a limb. */
+   constexpr int popcount_1( uint64_t x )
      {
-        assign( (int64_t)i );
+#ifdef __GNUC__
+        return __builtin_popcountll( x );
+#else
+        return x ? (int)( x & 1 ) + popcount_1( x >> 1 ) : 0;
+#endif
      }
    
-   LargeInteger( uint8_t i ) : r( NULL )
+   /* Reciprocal of a normalized divisor d (most significant bit set), that
+    * is floor( ( 2^128 - 1 ) / d ) - 2^64, as used by udiv_qrnnd_preinv.
+    */
+   MULTIINT_CONSTEXPR inline uint64_t reciprocal_2by1( uint64_t d )
      {
-        assign( (uint64_t)i );
+        uint128_t ones = ( (uint128_t)0xFFFFFFFFFFFFFFFFULL << 64 ) | (uint128_t)0xFFFFFFFFFFFFFFFFULL;
+        return (uint64_t)( ones / d );
      }
    
-   LargeInteger() : r( NULL )
+   /* Divides the two limbs u1:u0 by the normalized divisor d with u1 < d,
+    * using the reciprocal v of d so that only multiplications are needed
+    * (Moller & Granlund, "Improved division by invariant integers"). The
+    * remainder is stored in r, which may be the same variable as u1, and
+    * the quotient is returned.
+    */
+   MULTIINT_CONSTEXPR inline uint64_t udiv_qrnnd_preinv( uint64_t& r, uint64_t u1, uint64_t u0, uint64_t d, uint64_t v )
      {
-        for( int k = 0; k < L; ++k ) num[ k ] = 0;
+        uint128_t p = (uint128_t)v * (uint128_t)u1 + ( ( (uint128_t)u1 << 64 ) | (uint128_t)u0 );
+        uint64_t q1 = ( p >> 64 ) + 1;
+        uint64_t q0 = p & 0xFFFFFFFFFFFFFFFFULL;
+        uint64_t rem = u0 - q1 * d;
+        if( rem > q0 )
+          {
+             --q1;
+             rem += d;
+          }
+        if( rem >= d )
+          {
+             ++q1;
+             rem -= d;
+          }
+        r = rem;
+        return q1;
      }
    
-   LargeInteger( const LargeInteger& b ) : r( NULL )
+   /* q = a / ( d >> shift ), returns a % ( d >> shift ). d is the
+    * normalized divisor, shift the number of bits it was shifted by and v
+    * its reciprocal. The dividend is shifted on the fly. q may be the same
+    * array as a or NULL when only the remainder is needed.
+    */
+   MULTIINT_CONSTEXPR inline uint64_t divrem_1_preinv( uint64_t* q, const uint64_t* a, int n, uint64_t d, int shift, uint64_t v )
      {
-        for( int k = 0; k < L; ++k ) num[ k ] = b.num[ k ];
-        if( b.r ) r = new LargeInteger( *b.r );
+        uint64_t r = shift ? a[ 0 ] >> ( 64 - shift ) : 0;
+        for( int i = 0; i < n; ++i )
+          {
+             uint64_t u0 = a[ i ] << shift;
+             if( shift && i + 1 < n ) u0 |= a[ i+1 ] >> ( 64 - shift );
+             uint64_t qi = udiv_qrnnd_preinv( r, r, u0, d, v );
+             if( q ) q[ i ] = qi;
+          }
+        return r >> shift;
      }
    
-   ~LargeInteger()
+   /* Division of limb arrays by a divisor known at compile time. Powers of
+    * two become shifts, divisors below 2^32 are processed half a limb at a
+    * time so that the compiler turns each 64 bits division by the constant
+    * into a multiplication, and larger divisors use a reciprocal computed
+    * at compile time. q may be the same array as a or NULL when only the
+    * remainder is needed.
+    */
+   template< uint64_t D > struct ConstantDivisor
+     {
+        static_assert( D != 0, "Division by zero" );
+        
+        static const int shift = clz_1( D );
+        static const uint64_t norm = D << shift;
+        
+        static MULTIINT_CONSTEXPR uint64_t divrem( uint64_t* q, const uint64_t* a, int n )
+          {
+             if( ( D & ( D - 1 ) ) == 0 )
+               {
+                  const int s = 63 - shift;
+                  uint64_t r = a[ n-1 ] & ( D - 1 );
+                  if( q && s )
+                    {
+                       for( int i = n-1; i > 0; --i )
+                         q[ i ] = ( a[ i ] >> s ) | ( ( a[ i-1 ] << 1 ) << ( 63 - s ) );
+                       q[ 0 ] = a[ 0 ] >> s;
+                    }
+                  else if( q && q != a )
+                    {
+                       for( int i = 0; i < n; ++i ) q[ i ] = a[ i ];
+                    }
+                  return r;
+               }
+             
+             if( D < ( 1ULL << 32 ) )
+               {
+                  uint64_t r = 0;
+                  for( int i = 0; i < n; ++i )
+                    {
+                       uint64_t hi = ( r << 32 ) | ( a[ i ] >> 32 );
+                       uint64_t qh = hi / D;
+                       r = hi % D;
+                       uint64_t lo = ( r << 32 ) | ( a[ i ] & 0xFFFFFFFFULL );
+                       if( q ) q[ i ] = ( qh << 32 ) | ( lo / D );
+                       r = lo % D;
+                    }
+                  return r;
+               }
+             
+             MULTIINT_CONSTEXPR uint64_t inv = reciprocal_2by1( norm );
+             return divrem_1_preinv( q, a, n, norm, shift, inv );
+          }
+     };
+   
+   /* rp = ap - bp, returns the borrow out of the most significant limb. rp
+    * may be the same array as ap or bp.
+    */
+   MULTIINT_CONSTEXPR inline uint64_t sub_n( uint64_t* rp, const uint64_t* ap, const uint64_t* bp, int n )
      {
-        if( r ) delete r;
+        uint64_t borrow = 0;
+        for( int i = n-1; i >= 0; --i )
+          {
+             uint64_t a = ap[ i ];
+             uint64_t t = a - bp[ i ];
+             uint64_t nb = ( a < bp[ i ] ) | ( t < borrow );
+             rp[ i ] = t - borrow;
+             borrow = nb;
+          }
+        return borrow;
      }
    
-   LargeInteger( const std::string& s ) : r( NULL )
+   /* rp = ap * bp, rp has an + bn limbs. rp must not overlap the operands.
+    * This is the schoolbook product, one addmul_1 pass per limb of bp.
+    */
+   MULTIINT_CONSTEXPR inline void mul_basecase( uint64_t* rp, const uint64_t* ap, int an, const uint64_t* bp, int bn )
      {
-        parse( s );
+        for( int i = 0; i < an + bn; ++i ) rp[ i ] = 0;
+        for( int j = bn-1; j >= 0; --j )
+          rp[ j ] = addmul_1( rp + j + 1, ap, bp[ j ], rp + j + 1, an );
      }
    
-   LargeInteger& operator=( int64_t i )
+   /* rp = ap * bp mod 2^(64*n), rp has n <= an + bn limbs and must not
+    * overlap the operands. Only the limb products landing in the low n limbs
+    * are computed: each row adds the limbs of ap that still fit above the
+    * position of its limb of bp and writes its carry to the next untouched
+    * limb, which is dropped once it falls out of the result.
+    */
+   MULTIINT_CONSTEXPR inline void mullo_basecase( uint64_t* rp, const uint64_t* ap, int an, const uint64_t* bp, int bn, int n )
      {
-        assign( i );
-        return *this;
+        for( int i = 0; i < n; ++i ) rp[ i ] = 0;
+        for( int j = 0; j < bn && j < n; ++j )
+          {
+             int m = an < n - j ? an : n - j;
+             uint64_t* r = rp + n - j - m;
+             uint64_t c = addmul_1( r, ap + an - m, bp[ bn-1 - j ], r, m );
+             if( j + m < n ) r[ -1 ] = c;
+          }
      }
    
-   LargeInteger& operator=( uint64_t i )
+   /* Fused compare and subtract used by the division loops: if r >= d,
+    * considering both as unsigned, r becomes r - d and true is returned.
+    * Otherwise r is left untouched. The comparison stops at the first limb
+    * that differs and the subtraction only touches the limbs below it.
+    */
+   MULTIINT_CONSTEXPR inline bool csub_n( uint64_t* r, const uint64_t* d, int n )
      {
-        assign( i );
-        return *this;
+        int top = 0;
+        while( top < n && r[ top ] == d[ top ] ) ++top;
+        if( top < n && r[ top ] < d[ top ] ) return false;
+
+        uint64_t borrow = 0;
+        for( int i = n-1; i >= top; --i )
+          {
+             uint64_t a = r[ i ];
+             uint64_t t = a - d[ i ];
+             uint64_t nb = ( a < d[ i ] ) | ( t < borrow );
+             r[ i ] = t - borrow;
+             borrow = nb;
+          }
+        for( int i = 0; i < top; ++i ) r[ i ] = 0;
+        return true;
      }
    
-   LargeInteger& operator=( int32_t i )
+   /* rp = ap + bp, returns the carry out of the most significant limb. rp
+    * may be the same array as ap or bp.
+    */
+   MULTIINT_CONSTEXPR inline uint64_t add_n( uint64_t* rp, const uint64_t* ap, const uint64_t* bp, int n )
      {
-        assign( (int64_t)i );
-        return *this;
+        uint64_t carry = 0;
+        for( int i = n-1; i >= 0; --i )
+          {
+             uint64_t t = ap[ i ] + bp[ i ];
+             uint64_t c = t < ap[ i ];
+             rp[ i ] = t + carry;
+             carry = c | ( rp[ i ] < t );
+          }
+        return carry;
      }
    
-   LargeInteger& operator=( uint32_t i )
+   /* a += 1 and a -= 1, carries and borrows out of the top limb are lost. */
+   MULTIINT_CONSTEXPR inline void incr_n( uint64_t* a, int n )
      {
-        assign( (uint64_t)i );
-        return *this;
+        for( int i = n-1; i >= 0 && ++a[ i ] == 0; --i );
      }
    
-   LargeInteger& operator=( int16_t i )
+   MULTIINT_CONSTEXPR inline void decr_n( uint64_t* a, int n )
      {
-        assign( (int64_t)i );
-        return *this;
+        for( int i = n-1; i >= 0 && a[ i ]-- == 0; --i );
      }
    
-   LargeInteger& operator=( uint16_t i )
+   /* Schoolbook division, Knuth's algorithm D. u has nn+1 limbs, the first
+    * one being an extra top limb, and d has dn >= 2 limbs with its most
+    * significant bit set, both shifted by the same amount by the caller.
+    * The nn+1-dn limbs of the quotient go to q, which may be NULL, and the
+    * remainder is left in the last dn limbs of u. Each quotient limb is
+    * estimated from the top limbs of the partial remainder with the
+    * reciprocal of d[0] and the second limb of d, which leaves it at most
+    * one too large, fixed after the multiply and subtract.
+    */
+   MULTIINT_CONSTEXPR inline void divrem_basecase( uint64_t* q, uint64_t* u, int nn, const uint64_t* d, int dn )
      {
-        assign( (uint64_t)i );
-        return *this;
+        uint64_t v = reciprocal_2by1( d[ 0 ] );
+        for( int j = 0; j + dn <= nn; ++j )
+          {
+             uint64_t* w = u + j;
+             uint64_t qhat = ~0ULL, rhat = 0;
+             bool big = false;
+             if( w[ 0 ] >= d[ 0 ] )
+               {
+                  rhat = w[ 1 ] + d[ 0 ];
+                  big = rhat < w[ 1 ];
+               }
+             else qhat = udiv_qrnnd_preinv( rhat, w[ 0 ], w[ 1 ], d[ 0 ], v );
+             
+             while( !big )
+               {
+                  uint128_t p = (uint128_t)qhat * (uint128_t)d[ 1 ];
+                  uint64_t ph = p >> 64, pl = p & 0xFFFFFFFFFFFFFFFFULL;
+                  if( ph < rhat || ( ph == rhat && pl <= w[ 2 ] ) ) break;
+                  --qhat;
+                  rhat += d[ 0 ];
+                  big = rhat < d[ 0 ];
+               }
+             
+             uint64_t borrow = submul_1( w + 1, d, qhat, w + 1, dn );
+             if( w[ 0 ] < borrow )
+               {
+                  --qhat;
+                  add_n( w + 1, w + 1, d, dn );
+               }
+             w[ 0 ] = 0;
+             if( q ) q[ j ] = qhat;
+          }
      }
    
-   LargeInteger& operator=( int8_t i )
+   /* -1 / m modulo 2^64 for an odd m, by Newton's iteration: m is its own
+    * inverse modulo 8 and each step doubles the number of correct bits.
+    */
+   MULTIINT_CONSTEXPR inline uint64_t neg_inverse_1( uint64_t m )
      {
-        assign( (int64_t)i );
-        return *this;
+        uint64_t x = m;
+        for( int i = 0; i < 5; ++i ) x *= 2 - m * x;
+        return -x;
      }
    
-   LargeInteger& operator=( uint8_t i )
+   /* a * b / 2^64 mod p for an odd p below 2^63, minv being -1 / p mod
+    * 2^64. a * b must be below p * 2^64, the result is below p.
+    */
+   MULTIINT_CONSTEXPR inline uint64_t mont_mul_1( uint64_t a, uint64_t b, uint64_t p, uint64_t minv )
      {
-        assign( (uint64_t)i );
-        return *this;
+        uint128_t t = (uint128_t)a * (uint128_t)b;
+        uint64_t q = (uint64_t)( t & 0xFFFFFFFFFFFFFFFFULL ) * minv;
+        uint64_t u = ( t + (uint128_t)q * (uint128_t)p ) >> 64;
+        return u >= p ? u - p : u;
      }
    
-   LargeInteger& operator=( const LargeInteger& b )
+   /* a + b and a - b mod p, for a and b below p < 2^63. */
+   MULTIINT_CONSTEXPR inline uint64_t addmod_1( uint64_t a, uint64_t b, uint64_t p )
      {
-        if( r ) delete( r );
-        r = NULL;
-        for( int k = 0; k < L; ++k ) num[ k ] = b.num[ k ];
-        if( b.r ) r = new LargeInteger( *b.r );
-        return *this;
+        uint64_t r = a + b;
+        return r >= p ? r - p : r;
      }
    
-   LargeInteger& operator=( const std::string& s )
+   MULTIINT_CONSTEXPR inline uint64_t submod_1( uint64_t a, uint64_t b, uint64_t p )
      {
-        parse( s );
-        return *this;
+        return a >= b ? a - b : a + ( p - b );
      }
    
-   LargeInteger operator+( const LargeInteger& b ) const
+   /* Montgomery reduction: r = t / 2^(64*n) mod m, for t of 2n limbs below
+    * m * 2^(64*n) and an odd m of n limbs, minv being -1 / m mod 2^64. Each
+    * step clears the least significant limb left with a multiple of m, the
+    * carries going into the higher limbs of t, which is overwritten.
+    */
+   MULTIINT_CONSTEXPR inline void redc_n( uint64_t* r, uint64_t* t, const uint64_t* m, uint64_t minv, int n )
      {
-        LargeInteger res( 0 );
-        uint64_t carry = 0;
-        
-        for( int k = L-1; k >= 0; --k )
+        uint64_t top = 0;
+        for( int i = 0; i < n; ++i )
           {
-             uint128_t tmp = (uint128_t)num[ k ] + (uint128_t)b.num[ k ] + (uint128_t)carry;
-             carry = tmp >> 64;
-             res.num[ k ] = tmp & 0xFFFFFFFFFFFFFFFFULL;
+             uint64_t* w = t + n - i;
+             uint64_t c = addmul_1( w, m, w[ n-1 ] * minv, w, n );
+             for( int j = n-1 - i; c && j >= 0; --j )
+               {
+                  t[ j ] += c;
+                  c = t[ j ] < c;
+               }
+             top += c;
           }
-        
-        return res;
+        if( top ) sub_n( t, t, m, n );
+        else csub_n( t, m, n );
+        for( int i = 0; i < n; ++i ) r[ i ] = t[ i ];
      }
    
-   LargeInteger operator-( const LargeInteger& b ) const
+   /* Limb-wise boolean operations, andnot being a & ~b and not ignoring b. */
+   enum BitOp { bit_and, bit_or, bit_xor, bit_andnot, bit_not };
+   
+   template< int Op > MULTIINT_CONSTEXPR inline uint64_t bitop_1( uint64_t a, uint64_t b )
      {
-        return *this + -b;
+        return Op == bit_and ? a & b :
+               Op == bit_or ? a | b :
+               Op == bit_xor ? a ^ b :
+               Op == bit_andnot ? a & ~b : ~a;
      }
    
-   const LargeInteger& operator+() const
+   /* r = a op b, r may be the same array as a or b. */
+   template< int Op > MULTIINT_CONSTEXPR inline void bitop_n( uint64_t* r, const uint64_t* a, const uint64_t* b, int n )
      {
-        return *this;
+        for( int i = 0; i < n; ++i ) r[ i ] = bitop_1< Op >( a[ i ], Op == bit_not ? 0 : b[ i ] );
      }
    
-   LargeInteger operator-() const
+   /* ( a & b ) != 0, or a != 0 when b is NULL. */
+   MULTIINT_CONSTEXPR inline bool test_any( const uint64_t* a, const uint64_t* b, int n )
      {
-        LargeInteger tmp( *this );
-        tmp.negate();
-        return tmp;
+        for( int i = 0; i < n; ++i ) if( a[ i ] & ( b ? b[ i ] : ~0ULL ) ) return true;
+        return false;
      }
    
-   LargeInteger operator*( int64_t i ) const
+#ifdef MULTIINT_SIMD
+   /* Best instruction set of the processor: 2 for AVX-512, 1 for AVX2 and 0
+    * when only the scalar code can be used. Checked once.
+    */
+   inline int simd_level()
      {
-        bool leftneg = isNegative();
-        bool rightneg = ( i & ( 1LL << 63 ) ) != 0;
-        bool neg = false;
-        if( leftneg && !rightneg || !leftneg && rightneg ) neg = true;
-        const LargeInteger& left = leftneg ? -*this : *this;
-        if( rightneg ) i = -i;
-        
-        LargeInteger res( 0 );
-        uint64_t carry = 0;
-        
-        for( int k = L-1; k >= 0; --k )
-          {
-             uint128_t tmp = (uint128_t)i * (uint128_t)left.num[k] + (uint128_t)carry;
-             carry = tmp >> 64;
-             res.num[ k ] = tmp & 0xFFFFFFFFFFFFFFFFLL;
-          }
-        
-        if( neg ) res.negate();
-        return res;
+        static const int level = __builtin_cpu_supports( "avx512f" ) ? 2 :
+                                 __builtin_cpu_supports( "avx2" ) ? 1 : 0;
+        return level;
      }
    
-   LargeInteger operator*( uint64_t i ) const
+   /* a == b, 8 limbs per iteration. */
+   __attribute__(( target( "avx2" ) )) inline bool equal_avx2( const uint64_t* a, const uint64_t* b, int n )
      {
-        bool neg = isNegative();
-        const LargeInteger& left = neg ? -*this : *this;
-        
-        LargeInteger res( 0 );
-        uint64_t carry = 0;
-        
-        for( int k = L-1; k >= 0; --k )
+        int i = 0;
+        for( ; i + 8 <= n; i += 8 )
           {
-             uint128_t tmp = (uint128_t)i * (uint128_t)left.num[k] + (uint128_t)carry;
-             carry = tmp >> 64;
-             res.num[ k ] = tmp & 0xFFFFFFFFFFFFFFFFLL;
+             __m256i x0 = _mm256_xor_si256( _mm256_loadu_si256( (const __m256i*)( a + i ) ), _mm256_loadu_si256( (const __m256i*)( b + i ) ) );
+             __m256i x1 = _mm256_xor_si256( _mm256_loadu_si256( (const __m256i*)( a + i + 4 ) ), _mm256_loadu_si256( (const __m256i*)( b + i + 4 ) ) );
+             __m256i x = _mm256_or_si256( x0, x1 );
+             if( !_mm256_testz_si256( x, x ) ) return false;
           }
-        if( neg ) res.negate();
-        return res;
+        for( ; i < n; ++i ) if( a[ i ] != b[ i ] ) return false;
+        return true;
      }
    
-   LargeInteger operator*( int32_t i ) const
+   template< int Op > __attribute__(( target( "avx2" ) )) inline __m256i bitop_256( __m256i a, __m256i b )
      {
-        return *this * (int64_t)i;
+        return Op == bit_and ? _mm256_and_si256( a, b ) :
+               Op == bit_or ? _mm256_or_si256( a, b ) :
+               Op == bit_xor ? _mm256_xor_si256( a, b ) :
+               Op == bit_andnot ? _mm256_andnot_si256( b, a ) :
+               _mm256_xor_si256( a, _mm256_set1_epi64x( -1 ) );
      }
    
-   LargeInteger operator*( uint32_t i ) const
+   template< int Op > __attribute__(( target( "avx512f" ) )) inline __m512i bitop_512( __m512i a, __m512i b )
      {
-        return *this * (uint64_t)i;
+        return Op == bit_and ? _mm512_and_si512( a, b ) :
+               Op == bit_or ? _mm512_or_si512( a, b ) :
+               Op == bit_xor ? _mm512_xor_si512( a, b ) :
+               Op == bit_andnot ? _mm512_ternarylogic_epi64( a, b, b, 0x30 ) :
+               _mm512_ternarylogic_epi64( a, a, a, 0x55 );
      }
    
-   LargeInteger operator*( int16_t i ) const
+   /* bitop_n with 4 limbs per instruction. */
+   template< int Op > __attribute__(( target( "avx2" ) )) inline void bitop_avx2( uint64_t* r, const uint64_t* a, const uint64_t* b, int n )
      {
-        return *this * (int64_t)i;
+        int i = 0;
+        for( ; i + 4 <= n; i += 4 )
+          {
+             __m256i x = _mm256_loadu_si256( (const __m256i*)( a + i ) );
+             __m256i y = Op == bit_not ? x : _mm256_loadu_si256( (const __m256i*)( b + i ) );
+             _mm256_storeu_si256( (__m256i*)( r + i ), bitop_256< Op >( x, y ) );
+          }
+        for( ; i < n; ++i ) r[ i ] = bitop_1< Op >( a[ i ], Op == bit_not ? 0 : b[ i ] );
      }
    
-   LargeInteger operator*( uint16_t i ) const
+   /* bitop_n with 8 limbs per instruction. */
+   template< int Op > __attribute__(( target( "avx512f" ) )) inline void bitop_avx512( uint64_t* r, const uint64_t* a, const uint64_t* b, int n )
      {
-        return *this * (uint64_t)i;
+        int i = 0;
+        for( ; i + 8 <= n; i += 8 )
+          {
+             __m512i x = _mm512_loadu_si512( a + i );
+             __m512i y = Op == bit_not ? x : _mm512_loadu_si512( b + i );
+             _mm512_storeu_si512( r + i, bitop_512< Op >( x, y ) );
+          }
+        for( ; i < n; ++i ) r[ i ] = bitop_1< Op >( a[ i ], Op == bit_not ? 0 : b[ i ] );
      }
    
-   LargeInteger operator*( int8_t i ) const
+   template< int Op > inline void bitop_simd( uint64_t* r, const uint64_t* a, const uint64_t* b, int n )
      {
-        return *this * (int64_t)i;
+        if( simd_level() == 2 ) bitop_avx512< Op >( r, a, b, n );
+        else bitop_avx2< Op >( r, a, b, n );
      }
    
-   LargeInteger operator*( uint8_t i ) const
+   /* test_any with 8 limbs per iteration. */
+   __attribute__(( target( "avx2" ) )) inline bool test_any_avx2( const uint64_t* a, const uint64_t* b, int n )
      {
-        return *this * (uint64_t)i;
+        int i = 0;
+        for( ; i + 8 <= n; i += 8 )
+          {
+             __m256i x0 = _mm256_loadu_si256( (const __m256i*)( a + i ) );
+             __m256i x1 = _mm256_loadu_si256( (const __m256i*)( a + i + 4 ) );
+             __m256i y0 = b ? _mm256_loadu_si256( (const __m256i*)( b + i ) ) : x0;
+             __m256i y1 = b ? _mm256_loadu_si256( (const __m256i*)( b + i + 4 ) ) : x1;
+             __m256i x = _mm256_or_si256( _mm256_and_si256( x0, y0 ), _mm256_and_si256( x1, y1 ) );
+             if( !_mm256_testz_si256( x, x ) ) return true;
+          }
+        for( ; i < n; ++i ) if( a[ i ] & ( b ? b[ i ] : ~0ULL ) ) return true;
+        return false;
+     }
+#endif
+}
+
+namespace multiint_detail
+{
+   /* Worker threads kept from one fork_join to the next. The calling thread
+    * of run() takes its share of the tasks and, while the other ones are
+    * still running, helps with any queued task, so that tasks may fork in
+    * turn without exhausting the workers.
+    */
+   class ThreadPool
+   {
+    public:
+      static ThreadPool& get()
+        {
+           static ThreadPool pool;
+           return pool;
+        }
+      
+      /* Runs task( i ) for i from 0 to count-1 on up to count threads, the
+       * calling one included, and returns when all of them are done. The
+       * first exception thrown by a task is rethrown then.
+       */
+      template< class F > void run( int count, const F& task )
+        {
+           Batch b = { &call< F >, &task, count, 0, 0, std::exception_ptr() };
+           std::unique_lock< std::mutex > lock( mutex );
+           while( (int)workers.size() < count - 1 )
+             {
+                try
+                  {
+                     workers.push_back( std::thread( &ThreadPool::work, this ) );
+                  }
+                catch( ... )
+                  {
+                     break;
+                  }
+             }
+           queue.push_front( &b );
+           if( count > 1 ) wake.notify_all();
+           while( b.done < count )
+             {
+                if( !queue.empty() ) runNext( lock );
+                else finished.wait( lock );
+             }
+           if( b.error ) std::rethrow_exception( b.error );
+        }
+      
+    private:
+      struct Batch
+      {
+         void ( *call )( const void*, int );
+         const void* task;
+         int count;
+         int next;
+         int done;
+         std::exception_ptr error;
+      };
+      
+      std::mutex mutex;
+      std::condition_variable wake;
+      std::condition_variable finished;
+      std::deque< Batch* > queue;
+      std::vector< std::thread > workers;
+      bool stop;
+      
+      ThreadPool() : stop( false )
+        {
+        }
+      
+      ~ThreadPool()
+        {
+           {
+              std::lock_guard< std::mutex > lock( mutex );
+              stop = true;
+           }
+           wake.notify_all();
+           for( size_t k = 0; k < workers.size(); ++k ) workers[ k ].join();
+        }
+      
+      template< class F > static void call( const void* task, int i )
+        {
+           ( *(const F*)task )( i );
+        }
+      
+      /* Runs the next task of the first queued batch, with the lock held
+       * except during the task itself.
+       */
+      void runNext( std::unique_lock< std::mutex >& lock )
+        {
+           Batch* b = queue.front();
+           int i = b->next++;
+           if( b->next == b->count ) queue.pop_front();
+           lock.unlock();
+           std::exception_ptr error;
+           try
+             {
+                b->call( b->task, i );
+             }
+           catch( ... )
+             {
+                error = std::current_exception();
+             }
+           lock.lock();
+           if( error && !b->error ) b->error = error;
+           if( ++b->done == b->count ) finished.notify_all();
+        }
+      
+      void work()
+        {
+           std::unique_lock< std::mutex > lock( mutex );
+           while( true )
+             {
+                if( !queue.empty() ) runNext( lock );
+                else if( stop ) return;
+                else wake.wait( lock );
+             }
+        }
+   };
+   
+   /* Runs task( i ) for i from 0 to count-1 on the threads of the pool and
+    * the calling one. Tasks that cannot get a thread run on the calling
+    * one. The first exception thrown by a task is rethrown once all of them
+    * are done.
+    */
+   template< class F > void fork_join( int count, const F& task )
+     {
+        if( count > 1 ) ThreadPool::get().run( count, task );
+        else if( count == 1 ) task( 0 );
+     }
+   
+   /* Threads given to the products of operands of at least minLimbs limbs
+    * each, and size of the transforms below which they are not split.
+    */
+   class MultiplicationThreads
+   {
+    public:
+      std::atomic< int > threads;
+      std::atomic< int > minLimbs;
+      std::atomic< size_t > forkSize;
+      
+      static MultiplicationThreads& get()
+        {
+           static MultiplicationThreads settings;
+           return settings;
+        }
+      
+    private:
+      MultiplicationThreads() : threads( 1 ), minLimbs( MULTIINT_NTT_PARALLEL_THRESHOLD ), forkSize( MULTIINT_NTT_FORK_SIZE )
+        {
+        }
+   };
+}
+
+#ifdef MULTIINT_NTT
+namespace multiint_detail
+{
+   /* The three primes c * 2^k + 1 below 2^62 used by the transforms, with
+    * their Montgomery constants and those of the Chinese remainder
+    * reconstruction. Built once, on first use.
+    */
+   class NttPrimes
+   {
+    public:
+      struct Prime
+      {
+         uint64_t p, minv, r2;
+         /* Primitive root of unity of order 2^k, in Montgomery form. */
+         uint64_t root;
+         int k;
+         
+         uint64_t toMont( uint64_t x ) const
+           {
+              return mont_mul_1( x, r2, p, minv );
+           }
+         
+         uint64_t mul( uint64_t a, uint64_t b ) const
+           {
+              return mont_mul_1( a, b, p, minv );
+           }
+         
+         /* a^e, a in Montgomery form. */
+         uint64_t pow( uint64_t a, uint64_t e ) const
+           {
+              uint64_t res = toMont( 1 );
+              for( ; e; e >>= 1, a = mul( a, a ) ) if( e & 1 ) res = mul( res, a );
+              return res;
+           }
+      };
+      
+      Prime q[ 3 ];
+      /* 1 / p0 mod p1 and 1 / ( p0 p1 ) mod p2, in Montgomery form. */
+      uint64_t inv01, inv012;
+      /* p0 mod p2 in Montgomery form and p0 p1 as two limbs. */
+      uint64_t p0m2, p01[ 2 ];
+      
+      static const NttPrimes& get()
+        {
+           static const NttPrimes primes;
+           return primes;
+        }
+      
+    private:
+      NttPrimes()
+        {
+           const uint64_t c[ 3 ] = { 29, 69, 177 };
+           const int k[ 3 ] = { 57, 55, 54 };
+           const uint64_t g[ 3 ] = { 3, 5, 7 };
+           for( int i = 0; i < 3; ++i )
+             {
+                Prime& r = q[ i ];
+                r.p = ( c[ i ] << k[ i ] ) + 1;
+                r.k = k[ i ];
+                r.minv = neg_inverse_1( r.p );
+                r.r2 = -r.p % r.p;
+                for( int j = 0; j < 64; ++j ) r.r2 = addmod_1( r.r2, r.r2, r.p );
+                r.root = r.pow( r.toMont( g[ i ] ), c[ i ] );
+             }
+           inv01 = q[ 1 ].pow( q[ 1 ].toMont( q[ 0 ].p % q[ 1 ].p ), q[ 1 ].p - 2 );
+           p0m2 = q[ 2 ].toMont( q[ 0 ].p % q[ 2 ].p );
+           inv012 = q[ 2 ].pow( q[ 2 ].mul( p0m2, q[ 2 ].toMont( q[ 1 ].p % q[ 2 ].p ) ), q[ 2 ].p - 2 );
+           uint128_t p01w = (uint128_t)q[ 0 ].p * (uint128_t)q[ 1 ].p;
+           p01[ 0 ] = p01w >> 64;
+           p01[ 1 ] = p01w & 0xFFFFFFFFFFFFFFFFULL;
+        }
+   };
+   
+   /* Forward transform of the n = 2^lg values of a, in Montgomery form, by
+    * decimation in frequency: natural order in, bit reversed order out.
+    * w[ j * step ] is the j-th power of a primitive n-th root of unity.
+    */
+   inline void ntt_dif( uint64_t* a, size_t n, const uint64_t* w, size_t step, const NttPrimes::Prime& q )
+     {
+        for( size_t len = n / 2; len >= 1; len /= 2, step *= 2 )
+          for( size_t s = 0; s < n; s += 2 * len )
+            for( size_t j = 0; j < len; ++j )
+              {
+                 uint64_t u = a[ s + j ], v = a[ s + j + len ];
+                 a[ s + j ] = addmod_1( u, v, q.p );
+                 a[ s + j + len ] = q.mul( submod_1( u, v, q.p ), w[ j * step ] );
+              }
+     }
+   
+   /* Inverse of ntt_dif up to a factor n, by decimation in time: bit
+    * reversed order in, natural order out. w holds the powers of the inverse
+    * root.
+    */
+   inline void ntt_dit( uint64_t* a, size_t n, const uint64_t* w, size_t step, const NttPrimes::Prime& q )
+     {
+        for( size_t len = 1, st = step * ( n / 2 ); len < n; len *= 2, st /= 2 )
+          for( size_t s = 0; s < n; s += 2 * len )
+            for( size_t j = 0; j < len; ++j )
+              {
+                 uint64_t u = a[ s + j ], v = q.mul( a[ s + j + len ], w[ j * st ] );
+                 a[ s + j ] = addmod_1( u, v, q.p );
+                 a[ s + j + len ] = submod_1( u, v, q.p );
+              }
+     }
+   
+   /* ntt_dif on several threads: the butterflies of the first level are
+    * shared between them, then the two halves, which are independent
+    * transforms of size n/2, are forked. The values computed do not depend
+    * on the number of threads.
+    */
+   inline void ntt_dif_parallel( uint64_t* a, size_t n, const uint64_t* w, size_t step, const NttPrimes::Prime& q, int threads, size_t fork )
+     {
+        if( threads < 2 || n < fork || n < 2 )
+          {
+             ntt_dif( a, n, w, step, q );
+             return;
+          }
+        size_t half = n / 2;
+        fork_join( threads, [ = ]( int t )
+          {
+             for( size_t j = half * t / threads; j < half * ( t + 1 ) / threads; ++j )
+               {
+                  uint64_t u = a[ j ], v = a[ j + half ];
+                  a[ j ] = addmod_1( u, v, q.p );
+                  a[ j + half ] = q.mul( submod_1( u, v, q.p ), w[ j * step ] );
+               }
+          } );
+        fork_join( 2, [ = ]( int h )
+          {
+             ntt_dif_parallel( a + h * half, half, w, 2 * step, q, h ? threads - threads / 2 : threads / 2, fork );
+          } );
      }
    
-   LargeInteger operator*( const LargeInteger& b ) const
+   /* ntt_dit on several threads, the halves first then the last level. */
+   inline void ntt_dit_parallel( uint64_t* a, size_t n, const uint64_t* w, size_t step, const NttPrimes::Prime& q, int threads, size_t fork )
      {
-        bool leftneg = isNegative();
-        bool rightneg = b.isNegative();
-        bool neg = false;
-        if( leftneg && !rightneg || !leftneg && rightneg ) neg = true;
-        const LargeInteger& left = leftneg ? -*this : *this;
-        const LargeInteger& right = rightneg ? -b : b;
-        
-        LargeInteger res( 0 );
-        
-        for( int k = 0; k < L; ++k )
+        if( threads < 2 || n < fork || n < 2 )
           {
-             res += ( right * left.num[ k ] ) << ( L*8*8 - 64 * ( k+1 ) );
+             ntt_dit( a, n, w, step, q );
+             return;
           }
-        
-        if( neg ) res.negate();
-        return res;
-     }
-   
-   LargeInteger operator/( int64_t i ) const
-     {
-        bool leftneg = isNegative();
-        bool rightneg = ( i & ( 1LL << 63 ) ) != 0;
-        bool neg = false;
-        if( leftneg && !rightneg || !leftneg && rightneg ) neg = true;
-        const LargeInteger& left = leftneg ? -*this : *this;
-        if( rightneg ) i = -i;
-        
-        LargeInteger res( 0 );
-        uint128_t r( 0 );
-        
-        for( int k = 0; k < L; ++k )
+        size_t half = n / 2;
+        fork_join( 2, [ = ]( int h )
+          {
+             ntt_dit_parallel( a + h * half, half, w, 2 * step, q, h ? threads - threads / 2 : threads / 2, fork );
+          } );
+        fork_join( threads, [ = ]( int t )
+          {
+             for( size_t j = half * t / threads; j < half * ( t + 1 ) / threads; ++j )
+               {
+                  uint64_t u = a[ j ], v = q.mul( a[ j + half ], w[ j * step ] );
+                  a[ j ] = addmod_1( u, v, q.p );
+                  a[ j + half ] = submod_1( u, v, q.p );
+               }
+          } );
+     }
+   
+   /* Cyclic convolution of length n of the limbs of ap and bp, least
+    * significant first, modulo q. The result, in c, is in normal form.
+    * scratch holds 2n values.
+    */
+   inline void ntt_convolution( uint64_t* c, size_t n, const uint64_t* ap, int an, const uint64_t* bp, int bn, const NttPrimes::Prime& q,
+                                uint64_t* scratch, int threads, size_t fork )
+     {
+        int lg = 0;
+        while( ( (size_t)1 << lg ) < n ) ++lg;
+        uint64_t* w = scratch;
+        uint64_t* winv = scratch + n / 2;
+        uint64_t* b = scratch + n;
+        uint64_t root = q.pow( q.root, (uint64_t)1 << ( q.k - lg ) );
+        uint64_t rinv = q.pow( root, ( (uint64_t)1 << lg ) - 1 );
+        if( n > 1 ) w[ 0 ] = winv[ 0 ] = q.toMont( 1 );
+        for( size_t j = 1; j < n / 2; ++j )
           {
-             r = (uint128_t)r << 64 | (uint128_t)left.num[k];
-             res.num[k] = r / i;
-             r %= i;
+             w[ j ] = q.mul( w[ j-1 ], root );
+             winv[ j ] = q.mul( winv[ j-1 ], rinv );
           }
         
-        uint64_t r64 = r & 0xFFFFFFFFFFFFFFFFULL;
-        res.r = new LargeInteger( r64 );
-        if( neg ) res.negate();
-        if(leftneg) res.r->negate();
-        return res;
-     }
-   
-   LargeInteger operator/( uint64_t i ) const
-     {
-        bool neg = isNegative();
-        const LargeInteger& left = neg ? -*this : *this;
-        
-        LargeInteger res( 0 );
-        uint128_t r( 0 );
-        
-        for( int k = 0; k < L; ++k )
+        for( size_t j = 0; j < n; ++j ) c[ j ] = j < (size_t)an ? q.toMont( ap[ an-1 - j ] ) : 0;
+        ntt_dif_parallel( c, n, w, 1, q, threads, fork );
+        if( ap == bp && an == bn )
+          for( size_t j = 0; j < n; ++j ) c[ j ] = q.mul( c[ j ], c[ j ] );
+        else
           {
-             r = (uint128_t)r << 64 | (uint128_t)left.num[k];
-             res.num[k] = r / i;
-             r %= i;
+             for( size_t j = 0; j < n; ++j ) b[ j ] = j < (size_t)bn ? q.toMont( bp[ bn-1 - j ] ) : 0;
+             ntt_dif_parallel( b, n, w, 1, q, threads, fork );
+             for( size_t j = 0; j < n; ++j ) c[ j ] = q.mul( c[ j ], b[ j ] );
           }
+        ntt_dit_parallel( c, n, winv, 1, q, threads, fork );
         
-        uint64_t r64 = r & 0xFFFFFFFFFFFFFFFFULL;
-        res.r = new LargeInteger( r64 );
-        if( neg )
+        /* 1 / n in normal form brings the values back from Montgomery form. */
+        uint64_t ninv = q.mul( q.pow( q.toMont( n % q.p ), q.p - 2 ), 1 );
+        for( size_t j = 0; j < n; ++j ) c[ j ] = q.mul( c[ j ], ninv );
+     }
+   
+   /* rp = ap * bp, rp has an + bn limbs and must not overlap the operands.
+    * The limbs are the coefficients of the convolution, computed modulo
+    * three primes whose product exceeds all of them, then rebuilt by the
+    * Chinese remainder theorem and added with their carries. With several
+    * threads, the three convolutions run in parallel first.
+    */
+   inline void ntt_mul( uint64_t* rp, const uint64_t* ap, int an, const uint64_t* bp, int bn, int threads )
+     {
+        const NttPrimes& np = NttPrimes::get();
+        size_t m = an + bn - 1, n = 1;
+        while( n < m ) n *= 2;
+        std::vector< uint64_t > c( 3 * n ), scratch( 3 * 2 * n );
+        int groups = threads >= 3 ? 3 : 1;
+        size_t fork = MultiplicationThreads::get().forkSize.load( std::memory_order_relaxed );
+        fork_join( groups, [ & ]( int g )
           {
-             res.negate();
-             res.r->negate();
+             for( int i = g; i < 3; i += groups )
+               ntt_convolution( &c[ i * n ], n, ap, an, bp, bn, np.q[ i ], &scratch[ i * 2 * n ], threads / groups, fork );
+          } );
+        
+        const NttPrimes::Prime& q1 = np.q[ 1 ];
+        const NttPrimes::Prime& q2 = np.q[ 2 ];
+        uint64_t acc[ 2 ] = { 0, 0 };
+        for( int k = 0; k < an + bn; ++k )
+          {
+             uint64_t x[ 3 ] = { 0, 0, 0 };
+             if( (size_t)k < m )
+               {
+                  uint64_t v0 = c[ k ], r1 = c[ n + k ], r2 = c[ 2*n + k ];
+                  uint64_t v1 = q1.mul( submod_1( r1, v0 % q1.p, q1.p ), np.inv01 );
+                  uint64_t s = addmod_1( v0 % q2.p, q2.mul( v1 % q2.p, np.p0m2 ), q2.p );
+                  uint64_t v2 = q2.mul( submod_1( r2, s, q2.p ), np.inv012 );
+                  
+                  /* x = v0 + v1 p0 + v2 p0 p1 */
+                  uint128_t t = (uint128_t)v1 * (uint128_t)np.q[ 0 ].p + (uint128_t)v0;
+                  uint128_t lo = (uint128_t)v2 * (uint128_t)np.p01[ 1 ];
+                  uint128_t hi = (uint128_t)v2 * (uint128_t)np.p01[ 0 ];
+                  uint128_t l0 = (uint128_t)( t & 0xFFFFFFFFFFFFFFFFULL ) + (uint128_t)( lo & 0xFFFFFFFFFFFFFFFFULL );
+                  uint128_t l1 = (uint128_t)( t >> 64 ) + (uint128_t)( lo >> 64 ) + (uint128_t)( hi & 0xFFFFFFFFFFFFFFFFULL ) + (uint128_t)( l0 >> 64 );
+                  x[ 0 ] = l0 & 0xFFFFFFFFFFFFFFFFULL;
+                  x[ 1 ] = l1 & 0xFFFFFFFFFFFFFFFFULL;
+                  x[ 2 ] = ( hi >> 64 ) + ( l1 >> 64 );
+               }
+             uint128_t a0 = (uint128_t)acc[ 0 ] + (uint128_t)x[ 0 ];
+             uint128_t a1 = (uint128_t)acc[ 1 ] + (uint128_t)x[ 1 ] + (uint128_t)( a0 >> 64 );
+             rp[ an + bn - 1 - k ] = a0 & 0xFFFFFFFFFFFFFFFFULL;
+             acc[ 0 ] = a1 & 0xFFFFFFFFFFFFFFFFULL;
+             acc[ 1 ] = x[ 2 ] + ( a1 >> 64 );
           }
-        return res;
-     }
-   
-   LargeInteger operator/( int32_t i ) const
-     {
-        return *this / (int64_t)i;
      }
    
-   LargeInteger operator/( uint32_t i ) const
+   /* rp = ap * bp mod 2^(64*n), from the full product. */
+   inline void ntt_mullo( uint64_t* rp, const uint64_t* ap, int an, const uint64_t* bp, int bn, int n, int threads )
      {
-        return *this / (uint64_t)i;
+        std::vector< uint64_t > t( an + bn );
+        ntt_mul( &t[ 0 ], ap, an, bp, bn, threads );
+        for( int i = 0; i < n; ++i ) rp[ i ] = t[ an + bn - n + i ];
      }
-   
-   LargeInteger operator/( int16_t i ) const
+}
+#endif
+
+namespace multiint_detail
+{
+   inline int ntt_threads( int an, int bn )
      {
-        return *this / (int64_t)i;
+        const MultiplicationThreads& mt = MultiplicationThreads::get();
+        int threads = mt.threads.load( std::memory_order_relaxed );
+        int limbs = mt.minLimbs.load( std::memory_order_relaxed );
+        return threads > 1 && an >= limbs && bn >= limbs ? threads : 1;
      }
    
-   LargeInteger operator/( uint16_t i ) const
+   /* rp = ap * bp, rp has an + bn limbs and must not overlap the operands. */
+   MULTIINT_CONSTEXPR inline void mul_n( uint64_t* rp, const uint64_t* ap, int an, const uint64_t* bp, int bn )
      {
-        return *this / (uint64_t)i;
+#ifdef MULTIINT_NTT
+        if( an >= MULTIINT_NTT_THRESHOLD && bn >= MULTIINT_NTT_THRESHOLD && !MULTIINT_IS_CONSTANT_EVALUATED() )
+          {
+             ntt_mul( rp, ap, an, bp, bn, ntt_threads( an, bn ) );
+             return;
+          }
+#endif
+        mul_basecase( rp, ap, an, bp, bn );
      }
    
-   LargeInteger operator/( int8_t i ) const
+   /* rp = ap * bp mod 2^(64*n), rp has n <= an + bn limbs and must not
+    * overlap the operands.
+    */
+   MULTIINT_CONSTEXPR inline void mullo_n( uint64_t* rp, const uint64_t* ap, int an, const uint64_t* bp, int bn, int n )
      {
-        return *this / (int64_t)i;
+#ifdef MULTIINT_NTT
+        if( an >= 2 * MULTIINT_NTT_THRESHOLD && bn >= 2 * MULTIINT_NTT_THRESHOLD && !MULTIINT_IS_CONSTANT_EVALUATED() )
+          {
+             ntt_mullo( rp, ap, an, bp, bn, n, ntt_threads( an, bn ) );
+             return;
+          }
+#endif
+        mullo_basecase( rp, ap, an, bp, bn, n );
      }
    
-   LargeInteger operator/( uint8_t i ) const
+#ifdef MULTIINT_NTT
+   /* a >= b, where b has m <= n limbs and is zero extended. */
+   inline bool greater_equal( const uint64_t* a, int n, const uint64_t* b, int m )
      {
-        return *this / (uint64_t)i;
+        for( int i = 0; i < n - m; ++i ) if( a[ i ] ) return true;
+        a += n - m;
+        for( int i = 0; i < m; ++i ) if( a[ i ] != b[ i ] ) return a[ i ] > b[ i ];
+        return true;
      }
    
-   LargeInteger operator/( const LargeInteger& d ) const
+   /* x = floor( ( B^(2t) - 1 ) / d ), B being 2^64, within a few units, for
+    * d of t limbs with its most significant bit set. x has t+1 limbs. A
+    * Newton step x + x ( B^(2t) - d x ) / B^(2t), from the reciprocal of the
+    * top half of d, doubles the number of correct limbs, so the cost is a
+    * few products of t limbs.
+    */
+   inline void reciprocal_n( uint64_t* x, const uint64_t* d, int t )
      {
-        bool leftneg = isNegative();
-        bool rightneg = d.isNegative();
-        bool neg = false;
-        if( leftneg && !rightneg || !leftneg && rightneg ) neg = true;
-        const LargeInteger& left = leftneg ? -*this : *this;
-        const LargeInteger& right = rightneg ? -d : d;
+        if( t <= 16 )
+          {
+             std::vector< uint64_t > u( 2*t + 1, ~0ULL );
+             u[ 0 ] = 0;
+             divrem_basecase( x, &u[ 0 ], 2*t, d, t );
+             return;
+          }
+        int h = t / 2 + 2;
+        std::vector< uint64_t > xh( h + 1 ), p( 2*t + 1 ), e;
+        reciprocal_n( &xh[ 0 ], d, h );
         
-        if( d == 0 ) return num[ 0 ] / d.num[ 0 ];
+        /* e = B^(2t) - d xh B^(t-h), as a signed value of 2t+1 limbs. */
+        mul_n( &p[ 0 ], d, t, &xh[ 0 ], h + 1 );
+        for( int i = t + h + 1; i < 2*t + 1; ++i ) p[ i ] = 0;
+        for( int i = 0; i < 2*t + 1; ++i ) p[ i ] = ~p[ i ];
+        incr_n( &p[ 0 ], 2*t + 1 );
+        p[ 0 ] += 1;
+        bool neg = p[ 0 ] >> 63;
+        if( neg )
+          {
+             for( int i = 0; i < 2*t + 1; ++i ) p[ i ] = ~p[ i ];
+             incr_n( &p[ 0 ], 2*t + 1 );
+          }
         
-        LargeInteger res( 0 );
-        LargeInteger r;
+        /* x = xh B^(t-h) +- xh |e| / B^(t+h). The last t-2 limbs of e only
+         * change the result by a unit or two, they are left out.
+         */
+        int top = 0;
+        while( top < 2*t && p[ top ] == 0 ) ++top;
+        int en = 2*t + 1 - top;
+        int drop = en - 1 < t - 2 ? en - 1 : t - 2;
+        e.resize( h + 1 + en - drop );
+        mul_n( &e[ 0 ], &xh[ 0 ], h + 1, &p[ top ], en - drop );
+        for( int i = 0; i < t + 1; ++i ) x[ i ] = 0;
+        for( int i = 0; i <= h; ++i ) x[ i ] = xh[ i ];
+        int cn = h + 1 + en - ( t + h );
+        std::vector< uint64_t > corr( t + 1 );
+        for( int i = 0; i < cn && i < t + 1; ++i ) corr[ t - i ] = e[ cn - 1 - i ];
+        if( neg )
+          {
+             sub_n( x, x, &corr[ 0 ], t + 1 );
+             decr_n( x, t + 1 );
+          }
+        else add_n( x, x, &corr[ 0 ], t + 1 );
+     }
+   
+   /* q = n / d and r = n % d for d of dn limbs with its most significant bit
+    * set, and n of nn > dn limbs with n[0] < d[0], by multiplying n with a
+    * reciprocal of d precise enough for the quotient to be off by a few
+    * units, which are fixed with the remainder. q has nn-dn limbs, r has dn
+    * and may overlap n.
+    */
+   inline void divrem_newton( uint64_t* q, uint64_t* r, const uint64_t* n, int nn, const uint64_t* d, int dn )
+     {
+        /* The reciprocal needs as many limbs as the quotient plus one: d and
+         * n are either truncated or extended with zero limbs to t limbs
+         * and nn + t - dn limbs.
+         */
+        int k = nn + 1 - dn;
+        int t = k + 1;
+        std::vector< uint64_t > dt( t ), nt( nn + t - dn ), x( t + 1 );
+        for( int i = 0; i < t && i < dn; ++i ) dt[ i ] = d[ i ];
+        for( int i = 0; i < nn + t - dn && i < nn; ++i ) nt[ i ] = n[ i ];
+        reciprocal_n( &x[ 0 ], &dt[ 0 ], t );
         
-        for( int i = L*64; i >= 0; --i )
+        /* qe = nt x / B^(2t), with an extra top limb for the corrections.
+         * The last t-2 limbs of nt are left out, like in reciprocal_n.
+         */
+        int drop = t > 2 ? t - 2 : 0;
+        int len = nn + t - dn - drop;
+        std::vector< uint64_t > p( len + t + 1 );
+        mul_n( &p[ 0 ], &nt[ 0 ], len, &x[ 0 ], t + 1 );
+        std::vector< uint64_t > qe( k + 1 ), rem( k + dn + 1 );
+        for( int i = 0; i < k; ++i ) qe[ i + 1 ] = p[ i ];
+        
+        /* rem = n - qe d, as a signed value of k+dn+1 limbs. */
+        mul_n( &rem[ 0 ], &qe[ 0 ], k + 1, d, dn );
+        for( int i = 0; i < k + dn + 1; ++i ) rem[ i ] = ~rem[ i ];
+        incr_n( &rem[ 0 ], k + dn + 1 );
+        if( add_n( &rem[ 2 ], &rem[ 2 ], n, nn ) ) incr_n( &rem[ 0 ], 2 );
+        
+        while( rem[ 0 ] >> 63 )
+          {
+             decr_n( &qe[ 0 ], k + 1 );
+             if( add_n( &rem[ k + 1 ], &rem[ k + 1 ], d, dn ) ) incr_n( &rem[ 0 ], k + 1 );
+          }
+        while( greater_equal( &rem[ 0 ], k + dn + 1, d, dn ) )
+          {
+             incr_n( &qe[ 0 ], k + 1 );
+             if( sub_n( &rem[ k + 1 ], &rem[ k + 1 ], d, dn ) ) decr_n( &rem[ 0 ], k + 1 );
+          }
+        for( int i = 0; i < k - 1; ++i ) q[ i ] = qe[ i + 2 ];
+        for( int i = 0; i < dn; ++i ) r[ i ] = rem[ k + 1 + i ];
+     }
+#endif
+   
+   /* q = n / d and r = n % d for d of dn >= 2 limbs with a nonzero top limb
+    * and nn >= dn. q has nn+1-dn limbs and r has dn limbs. u and v are
+    * scratch arrays of nn+1 and dn limbs for the normalized operands.
+    * Large operands use the Newton reciprocal, the others Knuth's algorithm.
+    */
+   MULTIINT_CONSTEXPR inline void divrem_n( uint64_t* q, uint64_t* r, const uint64_t* n, int nn, const uint64_t* d, int dn, uint64_t* u, uint64_t* v )
+     {
+        int s = clz_1( d[ 0 ] );
+        u[ 0 ] = s ? n[ 0 ] >> ( 64 - s ) : 0;
+        lshift_or( u + 1, n, s, NULL, nn );
+        lshift_or( v, d, s, NULL, dn );
+#ifdef MULTIINT_NTT
+        if( dn >= MULTIINT_NEWTON_THRESHOLD && nn + 1 - dn >= MULTIINT_NEWTON_THRESHOLD && !MULTIINT_IS_CONSTANT_EVALUATED() )
+          {
+             divrem_newton( q, u + nn + 1 - dn, u, nn + 1, v, dn );
+             rshift_fill( r, u + nn + 1 - dn, s, 0, dn );
+             return;
+          }
+#endif
+        divrem_basecase( q, u, nn, v, dn );
+        rshift_fill( r, u + nn + 1 - dn, s, 0, dn );
+     }
+   
+   /* Appends to s the decimal digits of the n limbs of a, padded with zeros
+    * to at least digits characters. a is destroyed.
+    */
+   inline void to_decimal_basecase( std::string& s, uint64_t* a, int n, size_t digits )
+     {
+        size_t start = s.size();
+        int top = 0;
+        while( top < n && a[ top ] == 0 ) ++top;
+        while( top < n )
           {
-             r <<= 1;
-             r |= ( ( left & ( (LargeInteger)1 << i ) ) != 0 ) ? 1 : 0;
-             if( r >= right )
+             uint64_t chunk = ConstantDivisor< 10000000000000000000ULL >::divrem( a + top, a + top, n - top );
+             while( top < n && a[ top ] == 0 ) ++top;
+             for( int i = 0; i < 19 && ( chunk || top < n ); ++i )
                {
-                  r -= right;
-                  res |= ( (LargeInteger)1 << i );
+                  s += ( '0' + chunk % 10 );
+                  chunk /= 10;
                }
           }
-        
-        res.r = new LargeInteger( r );
-        if( neg ) res.negate();
-        if(leftneg) res.r->negate();
-        return res;
+        while( s.size() - start < digits ) s += '0';
+        std::reverse( s.begin() + start, s.end() );
      }
    
-   uint64_t operator%( uint64_t d ) const
+#ifdef MULTIINT_NTT
+   /* Same as to_decimal_basecase for large values, which are split by a
+    * power of 10^19 of about half their size, so that the divisions use the
+    * Newton reciprocal, and both parts are converted recursively. powers
+    * holds 10^(19 2^i) without leading zero limbs, filled as needed.
+    */
+   inline void to_decimal( std::string& s, uint64_t* a, int n, size_t digits, std::vector< std::vector< uint64_t > >& powers )
      {
-        return ( *this / d ).r->num[ L-1 ];
+        while( n > 0 && a[ 0 ] == 0 ) ++a, --n;
+        if( n < MULTIINT_NTT_THRESHOLD || n < 4 )
+          {
+             to_decimal_basecase( s, a, n, digits );
+             return;
+          }
+        
+        if( powers.empty() ) powers.push_back( std::vector< uint64_t >( 1, 10000000000000000000ULL ) );
+        while( 2 * (int) powers.back().size() <= n )
+          {
+             int pn = powers.back().size();
+             std::vector< uint64_t > sq( 2 * pn );
+             mul_n( &sq[ 0 ], &powers.back()[ 0 ], pn, &powers.back()[ 0 ], pn );
+             if( sq[ 0 ] == 0 ) sq.erase( sq.begin() );
+             powers.push_back( std::vector< uint64_t >() );
+             powers.back().swap( sq );
+          }
+        int k = powers.size() - 1;
+        while( 2 * (int) powers[ k ].size() > n + 1 ) --k;
+        
+        int dn = powers[ k ].size();
+        std::vector< uint64_t > q( n + 1 - dn ), r( dn ), u( n + 1 ), v( dn );
+        divrem_n( &q[ 0 ], &r[ 0 ], a, n, &powers[ k ][ 0 ], dn, &u[ 0 ], &v[ 0 ] );
+        size_t low = (size_t) 19 << k;
+        to_decimal( s, &q[ 0 ], n + 1 - dn, digits > low ? digits - low : 0, powers );
+        to_decimal( s, &r[ 0 ], dn, low, powers );
      }
+#endif
    
-   int64_t operator%( int64_t d ) const
+   /* Appends to s the decimal digits of the n limbs of a, which is
+    * destroyed, with the recursive conversion for large values.
+    */
+   inline void append_decimal( std::string& s, uint64_t* a, int n )
      {
-        return *(int64_t*)(&( *this / d ).r->num[ L-1 ]);
+#ifdef MULTIINT_NTT
+        if( n >= MULTIINT_NEWTON_THRESHOLD )
+          {
+             std::vector< std::vector< uint64_t > > powers;
+             to_decimal( s, a, n, 0, powers );
+             return;
+          }
+#endif
+        to_decimal_basecase( s, a, n, 0 );
      }
+}
+
+/* Sets the number of threads used by the products of operands of at least
+ * minLimbs limbs each, 1 by default. The transforms are split between the
+ * threads down to transforms of forkSize values, which does not change the
+ * results. The threads are kept in a pool reused by the following products.
+ * Products that do not use the number theoretic transforms stay on the
+ * calling thread.
+ */
+inline void setMultiplicationThreads( int threads, int minLimbs = MULTIINT_NTT_PARALLEL_THRESHOLD, size_t forkSize = MULTIINT_NTT_FORK_SIZE )
+{
+   multiint_detail::MultiplicationThreads& mt = multiint_detail::MultiplicationThreads::get();
+   mt.threads.store( threads > 1 ? threads : 1 );
+   mt.minLimbs.store( minLimbs );
+   mt.forkSize.store( forkSize );
+}
+
+/* A single limb divisor prepared once to be used in many divisions. The
+ * divisor is normalized and its reciprocal is computed by the constructor
+ * so that dividing a LargeInteger by it only needs multiplications, instead
+ * of a hardware division per limb.
+ */
+class Divisor64
+{
+ public:
+   explicit MULTIINT_CONSTEXPR Divisor64( uint64_t d )
+     : d( d ), shift( d ? multiint_detail::clz_1( d ) : 0 ), norm( d << shift ),
+       inv( d ? multiint_detail::reciprocal_2by1( norm ) : 0 )
+       {
+          if( d == 0 ) throw std::invalid_argument( "Division by zero" );
+       }
    
-   uint32_t operator%( uint32_t d ) const
+   MULTIINT_CONSTEXPR uint64_t divisor() const
      {
-        return ( *this / d ).r->num[ L-1 ];
+        return d;
      }
    
-   int32_t operator%( int32_t d ) const
+   /* q = a / d on n limbs stored most significant first, returns a % d. q
+    * may be the same array as a or NULL when only the remainder is needed.
+    */
+   MULTIINT_CONSTEXPR uint64_t divrem( uint64_t* q, const uint64_t* a, int n ) const
      {
-        return *(int32_t*)(&( *this / d ).r->num[ L-1 ] );
+        return multiint_detail::divrem_1_preinv( q, a, n, norm, shift, inv );
      }
    
-   uint16_t operator%( uint16_t d ) const
+ private:
+   uint64_t d;
+   int shift;
+   uint64_t norm;
+   uint64_t inv;
+};
+
+template< class E > class IntegerExpression;
+template< int W, typename u128, bool S > class DivisionResult;
+
+/* This will generate an error at compilation time if the user try to
+ * define a LargeInteger with a length that is not a multiple of 64.
+ * This restriction is required as our integer are compound of 64 bits
+ * integers. Moreover, supporting all length would add a lot of complexity
+ * with possible performance impact. It should not be a big deal as we are
+ * supposed to handle large numbers so a few bits more of less should not make
+ * any difference :-)
+ */
+template< int R > class IntegerWidthShouldBeMultipleOf64;
+
+template<> class IntegerWidthShouldBeMultipleOf64< 0 >
+{
+};
+
+/* S tells whether the integer is signed, using two's complement, or
+ * unsigned. Unsigned integers never go through the sign handling of the
+ * multiplications, divisions and comparisons and their right shift is a
+ * logical one. See also UnsignedLargeInteger.
+ */
+template< int W, typename u128 = uint128_t, bool S = true > class LargeInteger : private IntegerWidthShouldBeMultipleOf64< W & 0x3F >
+{
+ public:
+   /* Number of 64 bits limbs of the representation. */
+   static const int L = W / 64;
+   
+   MULTIINT_CONSTEXPR LargeInteger( int64_t i ) : num()
      {
-        return ( *this / d ).r->num[ L-1 ];
+        assign( i );
      }
    
-   int16_t operator%( int16_t d ) const
+   MULTIINT_CONSTEXPR LargeInteger( uint64_t i ) : num()
      {
-        return *(int16_t*)(&( *this / d ).r->num[ L-1 ] );
+        assign( i );
      }
    
-   uint8_t operator%( uint8_t d ) const
+   MULTIINT_CONSTEXPR LargeInteger( int32_t i ) : num()
      {
-        return ( *this / d ).r->num[ L-1 ];
+        assign( (int64_t)i );
      }
    
-   int8_t operator%( int8_t d ) const
+   MULTIINT_CONSTEXPR LargeInteger( uint32_t i ) : num()
      {
-        return *(int8_t*)(&( *this / d ).r->num[ L-1 ] );
+        assign( (uint64_t)i );
      }
    
-   LargeInteger operator%( const LargeInteger& d ) const
+   MULTIINT_CONSTEXPR LargeInteger( int16_t i ) : num()
      {
-        return *( *this / d ).r;
+        assign( (int64_t)i );
      }
    
-   const LargeInteger& getRemaining() const
+   MULTIINT_CONSTEXPR LargeInteger( uint16_t i ) : num()
      {
-        return *r;
+        assign( (uint64_t)i );
      }
    
-   LargeInteger& operator++()
+   MULTIINT_CONSTEXPR LargeInteger( int8_t i ) : num()
      {
-        *this += 1;
-        return *this;
+        assign( (int64_t)i );
      }
    
-   LargeInteger operator++( int )
+   MULTIINT_CONSTEXPR LargeInteger( uint8_t i ) : num()
      {
-        LargeInteger tmp( *this );
-        *this += 1;
-        return tmp;
+        assign( (uint64_t)i );
      }
    
-   LargeInteger& operator--()
+   MULTIINT_CONSTEXPR LargeInteger() : num()
      {
-        *this -= 1;
-        return *this;
      }
    
-   LargeInteger operator--( int )
+   LargeInteger( const std::string& s ) : num()
      {
-        LargeInteger tmp( *this );
-        *this -= 1;
-        return tmp;
+        parse( s );
      }
    
-   bool operator==( const LargeInteger& b ) const
+   template< class E > LargeInteger( const IntegerExpression< E >& e ) : num()
      {
-        for( int k = 0; k < L; ++k ) 
-          if( num[ k ] != b.num[ k ] ) 
-            return false;
-        return true;
+        e.self().evalTo( *this );
      }
    
-   bool operator!=( const LargeInteger& b ) const
+   MULTIINT_CONSTEXPR LargeInteger& operator=( int64_t i )
      {
-        return !( *this == b );
+        assign( i );
+        return *this;
      }
    
-   bool operator>( const LargeInteger& b ) const
+   MULTIINT_CONSTEXPR LargeInteger& operator=( uint64_t i )
      {
-        return !( *this < b ) && ( *this != b );
+        assign( i );
+        return *this;
      }
    
-   bool operator<( const LargeInteger& b ) const
+   MULTIINT_CONSTEXPR LargeInteger& operator=( int32_t i )
      {
-        if( isNegative() != b.isNegative() ) return (int64_t)num[ 0 ] < (int64_t)b.num[ 0 ];
-        
-        for( int k = 0; k < L; ++k )
-          {
-             if( num[ k ] < b.num[ k ] )
-               return true;
-             else if( num[ k ] > b.num[ k ] )
-               return false;
-          }
-        return false;
+        assign( (int64_t)i );
+        return *this;
      }
    
-   bool operator>=( const LargeInteger& b ) const
+   MULTIINT_CONSTEXPR LargeInteger& operator=( uint32_t i )
      {
-        return !( *this < b );
+        assign( (uint64_t)i );
+        return *this;
      }
    
-   bool operator<=( const LargeInteger& b ) const
+   MULTIINT_CONSTEXPR LargeInteger& operator=( int16_t i )
      {
-        return ( *this < b ) || ( *this == b );
+        assign( (int64_t)i );
+        return *this;
      }
    
-   LargeInteger operator~() const
+   MULTIINT_CONSTEXPR LargeInteger& operator=( uint16_t i )
      {
-        LargeInteger res;
-        for( int k = 0; k < L; ++k )
-          res.num[ k ] = ~num[ k ];
-        return res;
+        assign( (uint64_t)i );
+        return *this;
      }
    
-   LargeInteger operator&( const LargeInteger& b ) const
+   MULTIINT_CONSTEXPR LargeInteger& operator=( int8_t i )
      {
-        LargeInteger res;
-        for( int k = 0; k < L; ++k )
-          res.num[ k ] = num[ k ] & b.num[ k ];
-        return res;
+        assign( (int64_t)i );
+        return *this;
      }
    
-   LargeInteger operator|( const LargeInteger& b ) const
+   MULTIINT_CONSTEXPR LargeInteger& operator=( uint8_t i )
      {
-        LargeInteger res;
-        for( int k = 0; k < L; ++k )
-          res.num[ k ] = num[ k ] | b.num[ k ];
-        return res;
+        assign( (uint64_t)i );
+        return *this;
      }
    
-   LargeInteger operator^( const LargeInteger& b ) const
+   LargeInteger& operator=( const std::string& s )
      {
-        LargeInteger res;
-        for( int k = 0; k < L; ++k )
-          res.num[ k ] = num[ k ] ^ b.num[ k ];
-        return res;
+        parse( s );
+        return *this;
      }
    
-   LargeInteger operator<<( int l ) const
+   template< class E > LargeInteger& operator=( const IntegerExpression< E >& e )
      {
-        LargeInteger res = *this;
-        while( l >= 64 )
-          {
-             for( int k=0; k<L-1; ++k )
-               res.num[ k ] = res.num[ k+1 ];
-             res.num[ L-1 ] = 0;
-             l -= 64;
-          }
-        
-        for( int k=0; k<L-1; ++k )
-          {
-             res.num[ k ] <<= l;
-             res.num[ k ] |= ( ( res.num[ k+1 ] >> (64-l) ) & ( ( 1 << l ) - 1 ) );
-          }
-        res.num[ L-1 ] <<= l;
-        return res;
+        e.self().evalTo( *this );
+        return *this;
      }
    
-   LargeInteger operator>>( int r ) const
+   MULTIINT_CONSTEXPR LargeInteger operator+( const LargeInteger& b ) const
      {
-        LargeInteger res = *this;
-        while( r >= 64 )
-          {
-             for( int k=L-1; k>0; --k )
-               res.num[ k ] = res.num[ k-1 ];
-             res.num[ 0 ] = (int64_t)res.num[ 0 ] >> 63;
-             r -= 64;
-          }
+        LargeInteger res( 0 );
+        uint64_t carry = 0;
         
-        for( int k=L-1; k>0; --k )
+        for( int k = L-1; k >= 0; --k )
           {
-             res.num[ k ] >>= r;
-             res.num[ k ] |= ( ( res.num[ k-1 ] & ( ( 1 << r ) - 1 ) ) << (64-r) );
+             uint128_t tmp = (uint128_t)num[ k ] + (uint128_t)b.num[ k ] + (uint128_t)carry;
+             carry = tmp >> 64;
+             res.num[ k ] = tmp & 0xFFFFFFFFFFFFFFFFULL;
           }
-        res.num[ 0 ] = (int64_t)res.num[ 0 ] >> r;
+        
         return res;
      }
    
-   LargeInteger& operator+=( const LargeInteger& b )
+   MULTIINT_CONSTEXPR LargeInteger operator-( const LargeInteger& b ) const
      {
-        *this = *this + b;
-        return *this;
+        return *this + -b;
      }
    
-   LargeInteger& operator-=( const LargeInteger& b )
+   MULTIINT_CONSTEXPR const LargeInteger& operator+() const
      {
-        *this = *this - b;
         return *this;
      }
    
-   LargeInteger& operator*=( const LargeInteger& b )
+   MULTIINT_CONSTEXPR LargeInteger operator-() const
      {
-        *this = *this * b;
-        return *this;
+        LargeInteger tmp( *this );
+        tmp.negate();
+        return tmp;
      }
    
-   LargeInteger& operator*=( uint64_t i )
+   MULTIINT_CONSTEXPR LargeInteger operator*( int64_t i ) const
      {
-        *this = *this * i;
-        return *this;
+        uint64_t u = i;
+        return product( num + L - signedLimbs(), signedLimbs(), isNegative(), &u, 1, i < 0 );
      }
    
-   LargeInteger& operator*=( int64_t i )
+   MULTIINT_CONSTEXPR LargeInteger operator*( uint64_t i ) const
      {
-        *this = *this * i;
-        return *this;
+        return product( num + L - signedLimbs(), signedLimbs(), isNegative(), &i, 1, false );
      }
    
-   LargeInteger& operator*=( uint32_t i )
+   MULTIINT_CONSTEXPR LargeInteger operator*( int32_t i ) const
      {
-        *this = *this * i;
-        return *this;
+        return *this * (int64_t)i;
      }
    
-   LargeInteger& operator*=( int32_t i )
+   MULTIINT_CONSTEXPR LargeInteger operator*( uint32_t i ) const
      {
-        *this = *this * i;
-        return *this;
+        return *this * (uint64_t)i;
      }
    
-   LargeInteger& operator*=( uint16_t i )
+   MULTIINT_CONSTEXPR LargeInteger operator*( int16_t i ) const
      {
-        *this = *this * i;
-        return *this;
+        return *this * (int64_t)i;
      }
    
-   LargeInteger& operator*=( int16_t i )
+   MULTIINT_CONSTEXPR LargeInteger operator*( uint16_t i ) const
      {
-        *this = *this * i;
-        return *this;
+        return *this * (uint64_t)i;
      }
    
-   LargeInteger& operator*=( uint8_t i )
+   MULTIINT_CONSTEXPR LargeInteger operator*( int8_t i ) const
      {
-        *this = *this * i;
-        return *this;
+        return *this * (int64_t)i;
      }
    
-   LargeInteger& operator*=( int8_t i )
+   MULTIINT_CONSTEXPR LargeInteger operator*( uint8_t i ) const
      {
-        *this = *this * i;
-        return *this;
+        return *this * (uint64_t)i;
      }
    
-   LargeInteger& operator/=( const LargeInteger& b )
+   MULTIINT_CONSTEXPR LargeInteger operator*( const LargeInteger& b ) const
      {
-        *this = *this / b;
-        return *this;
+        int na = signedLimbs();
+        int nb = b.signedLimbs();
+        return product( num + L - na, na, isNegative(), b.num + L - nb, nb, b.isNegative() );
      }
    
-   LargeInteger& operator/=( uint64_t i )
+   MULTIINT_CONSTEXPR DivisionResult< W, u128, S > operator/( int64_t i ) const
      {
-        *this = *this / i;
-        return *this;
+        if( !S && i < 0 ) return *this / LargeInteger( i );
+        
+        bool leftneg = isNegative();
+        bool rightneg = i < 0;
+        bool neg = leftneg != rightneg;
+        LargeInteger lefttmp;
+        const LargeInteger& left = magnitude( lefttmp );
+        uint64_t d = rightneg ? -(uint64_t)i : i;
+        int nl = left.significantLimbs();
+        if( nl == 0 ) nl = 1;
+        
+        LargeInteger res;
+        LargeInteger r( multiint_detail::divrem_1( res.num + L - nl, left.num + L - nl, d, nl ) );
+        if( neg ) res.negate();
+        if( leftneg ) r.negate();
+        return DivisionResult< W, u128, S >( res, r );
      }
    
-   LargeInteger& operator/=( int64_t i )
+   MULTIINT_CONSTEXPR DivisionResult< W, u128, S > operator/( uint64_t i ) const
      {
-        *this = *this / i;
-        return *this;
+        bool neg = isNegative();
+        LargeInteger lefttmp;
+        const LargeInteger& left = magnitude( lefttmp );
+        int nl = left.significantLimbs();
+        if( nl == 0 ) nl = 1;
+        
+        LargeInteger res;
+        LargeInteger r( multiint_detail::divrem_1( res.num + L - nl, left.num + L - nl, i, nl ) );
+        if( neg )
+          {
+             res.negate();
+             r.negate();
+          }
+        return DivisionResult< W, u128, S >( res, r );
      }
    
-   LargeInteger& operator/=( uint32_t i )
+   MULTIINT_CONSTEXPR DivisionResult< W, u128, S > operator/( int32_t i ) const
      {
-        *this = *this / i;
-        return *this;
+        return *this / (int64_t)i;
      }
    
-   LargeInteger& operator/=( int32_t i )
+   MULTIINT_CONSTEXPR DivisionResult< W, u128, S > operator/( uint32_t i ) const
      {
-        *this = *this / i;
-        return *this;
+        return *this / (uint64_t)i;
      }
    
-   LargeInteger& operator/=( uint16_t i )
+   MULTIINT_CONSTEXPR DivisionResult< W, u128, S > operator/( int16_t i ) const
      {
-        *this = *this / i;
-        return *this;
+        return *this / (int64_t)i;
      }
    
-   LargeInteger& operator/=( int16_t i )
+   MULTIINT_CONSTEXPR DivisionResult< W, u128, S > operator/( uint16_t i ) const
      {
-        *this = *this / i;
-        return *this;
+        return *this / (uint64_t)i;
      }
    
-   LargeInteger& operator/=( uint8_t i )
+   MULTIINT_CONSTEXPR DivisionResult< W, u128, S > operator/( int8_t i ) const
      {
-        *this = *this / i;
-        return *this;
+        return *this / (int64_t)i;
      }
    
-   LargeInteger& operator/=( int8_t i )
+   MULTIINT_CONSTEXPR DivisionResult< W, u128, S > operator/( uint8_t i ) const
      {
-        *this = *this / i;
-        return *this;
+        return *this / (uint64_t)i;
      }
    
-   LargeInteger& operator%=( const LargeInteger& b )
+   MULTIINT_CONSTEXPR DivisionResult< W, u128, S > operator/( const LargeInteger& d ) const
      {
-        *this = *this % b;
-        return *this;
+        bool leftneg = isNegative();
+        bool rightneg = d.isNegative();
+        bool neg = leftneg != rightneg;
+        LargeInteger lefttmp;
+        const LargeInteger& left = magnitude( lefttmp );
+        LargeInteger righttmp;
+        const LargeInteger& right = d.magnitude( righttmp );
+        
+        if( d == 0 ) return DivisionResult< W, u128, S >( num[ 0 ] / d.num[ 0 ], 0 );
+        
+        LargeInteger res( 0 );
+        LargeInteger r;
+        int nl = left.significantLimbs();
+        int nr = right.significantLimbs();
+        
+        if( nr == 1 )
+          {
+             r.num[ L-1 ] = multiint_detail::divrem_1( res.num + L - nl, left.num + L - nl, right.num[ L-1 ], nl );
+          }
+        else if( nl < nr ) r = left;
+#ifdef USE_NATIVE_INT128
+        else if( L > 1 && nl <= 2 )
+          {
+             uint128_t a = ( (uint128_t)left.num[ L-2 ] << 64 ) | left.num[ L-1 ];
+             uint128_t b = ( (uint128_t)right.num[ L-2 ] << 64 ) | right.num[ L-1 ];
+             uint128_t q = a / b;
+             uint128_t m = a % b;
+             res.num[ L-1 ] = (uint64_t)q;
+             res.num[ L-2 ] = (uint64_t)( q >> 64 );
+             r.num[ L-1 ] = (uint64_t)m;
+             r.num[ L-2 ] = (uint64_t)( m >> 64 );
+          }
+#endif
+        else
+          {
+             uint64_t u[ L + 1 ] = {};
+             uint64_t v[ L ] = {};
+             multiint_detail::divrem_n( res.num + L - ( nl + 1 - nr ), r.num + L - nr, left.num + L - nl, nl, right.num + L - nr, nr, u, v );
+          }
+        
+        if( neg ) res.negate();
+        if( leftneg ) r.negate();
+        return DivisionResult< W, u128, S >( res, r );
      }
    
-   LargeInteger& operator%=( uint64_t i )
+   /* Division by a constant known at compile time. Each limb step is done
+    * with multiplications and shifts instead of a hardware division, see
+    * multiint_detail::ConstantDivisor. The result is the same as *this / D.
+    */
+   template< uint64_t D > MULTIINT_CONSTEXPR DivisionResult< W, u128, S > divBy() const
      {
-        *this = *this % i;
-        return *this;
+        bool neg = isNegative();
+        LargeInteger res = *this;
+        if( neg ) res.negate();
+        int nl = res.significantLimbs();
+        if( nl == 0 ) nl = 1;
+        LargeInteger r( multiint_detail::ConstantDivisor< D >::divrem( res.num + L - nl, res.num + L - nl, nl ) );
+        if( neg )
+          {
+             res.negate();
+             r.negate();
+          }
+        return DivisionResult< W, u128, S >( res, r );
      }
    
-   LargeInteger& operator%=( int64_t i )
+   /* Division by a single limb divisor prepared with Divisor64, to be used
+    * when many numbers are divided by the same value. The results are the
+    * same as with the uint64_t division operators.
+    */
+   MULTIINT_CONSTEXPR DivisionResult< W, u128, S > divRem( const Divisor64& d ) const
      {
-        *this = *this % i;
-        return *this;
+        bool neg = isNegative();
+        LargeInteger res = *this;
+        if( neg ) res.negate();
+        int nl = res.significantLimbs();
+        if( nl == 0 ) nl = 1;
+        LargeInteger r( d.divrem( res.num + L - nl, res.num + L - nl, nl ) );
+        if( neg )
+          {
+             res.negate();
+             r.negate();
+          }
+        return DivisionResult< W, u128, S >( res, r );
      }
    
-   LargeInteger& operator%=( uint32_t i )
+   MULTIINT_CONSTEXPR DivisionResult< W, u128, S > operator/( const Divisor64& d ) const
      {
-        *this = *this % i;
-        return *this;
+        return divRem( d );
      }
    
-   LargeInteger& operator%=( int32_t i )
+   MULTIINT_CONSTEXPR uint64_t operator%( const Divisor64& d ) const
      {
-        *this = *this % i;
-        return *this;
+        bool neg = isNegative();
+        LargeInteger lefttmp;
+        const LargeInteger& left = magnitude( lefttmp );
+        int nl = left.significantLimbs();
+        if( nl == 0 ) nl = 1;
+        uint64_t r = d.divrem( NULL, left.num + L - nl, nl );
+        return neg ? -r : r;
      }
    
-   LargeInteger& operator%=( uint16_t i )
+   /* Remainder of the division by a constant known at compile time, the
+    * same as *this % D but the quotient is not computed.
+    */
+   template< uint64_t D > MULTIINT_CONSTEXPR uint64_t modBy() const
      {
-        *this = *this % i;
-        return *this;
+        bool neg = isNegative();
+        LargeInteger lefttmp;
+        const LargeInteger& left = magnitude( lefttmp );
+        int nl = left.significantLimbs();
+        if( nl == 0 ) nl = 1;
+        uint64_t r = multiint_detail::ConstantDivisor< D >::divrem( NULL, left.num + L - nl, nl );
+        return neg ? -r : r;
      }
    
-   LargeInteger& operator%=( int16_t i )
+   MULTIINT_CONSTEXPR uint64_t operator%( uint64_t d ) const
      {
-        *this = *this % i;
-        return *this;
+        return ( *this / d ).getRemaining().num[ L-1 ];
      }
    
-   LargeInteger& operator%=( uint8_t i )
+   MULTIINT_CONSTEXPR int64_t operator%( int64_t d ) const
      {
-        *this = *this % i;
-        return *this;
+        return (int64_t)( *this / d ).getRemaining().num[ L-1 ];
      }
    
-   LargeInteger& operator%=( int8_t i )
+   MULTIINT_CONSTEXPR uint32_t operator%( uint32_t d ) const
      {
-        *this = *this % i;
-        return *this;
+        return ( *this / d ).getRemaining().num[ L-1 ];
      }
    
-   LargeInteger& operator&=( const LargeInteger& b )
+   MULTIINT_CONSTEXPR int32_t operator%( int32_t d ) const
      {
-        *this = *this & b;
-        return *this;
+        return (int32_t)( *this / d ).getRemaining().num[ L-1 ];
      }
    
-   LargeInteger& operator|=( const LargeInteger& b )
+   MULTIINT_CONSTEXPR uint16_t operator%( uint16_t d ) const
      {
-        *this = *this | b;
-        return *this;
+        return ( *this / d ).getRemaining().num[ L-1 ];
      }
    
-   LargeInteger& operator^=( const LargeInteger& b )
+   MULTIINT_CONSTEXPR int16_t operator%( int16_t d ) const
      {
-        *this = *this ^ b;
-        return *this;
+        return (int16_t)( *this / d ).getRemaining().num[ L-1 ];
      }
    
-   LargeInteger& operator<<=( int l )
+   MULTIINT_CONSTEXPR uint8_t operator%( uint8_t d ) const
      {
-        *this = *this << l;
-        return *this;
+        return ( *this / d ).getRemaining().num[ L-1 ];
+     }
+   
+   MULTIINT_CONSTEXPR int8_t operator%( int8_t d ) const
+     {
+        return (int8_t)( *this / d ).getRemaining().num[ L-1 ];
+     }
+   
+   MULTIINT_CONSTEXPR LargeInteger operator%( const LargeInteger& d ) const
+     {
+        return ( *this / d ).getRemaining();
      }
    
-   LargeInteger& operator>>=( int l )
+   MULTIINT_CONSTEXPR LargeInteger& operator++()
      {
-        *this = *this >> l;
+        *this += 1;
         return *this;
      }
    
-   operator std::string() const
+   MULTIINT_CONSTEXPR LargeInteger operator++( int )
      {
-        if( isNegative() )
-          {
-             const_cast<LargeInteger*>(this)->negate();
-             std::string s = "-";
-             s += (std::string)(*this);
-             const_cast<LargeInteger*>(this)->negate();
-             return s;
-          }
-        
-        if( !isPositive() ) return "0";
-        
-        std::string s;
-        LargeInteger tmp = *this;
-        while( tmp.isPositive() )
-          {
-             tmp /= 10;
-             s += ( '0' + tmp.r->num[ L-1 ] );
-          }
-        std::reverse( s.begin(), s.end() );
-        return s;
+        LargeInteger tmp( *this );
+        *this += 1;
+        return tmp;
      }
    
-   std::string toHexString() const
+   MULTIINT_CONSTEXPR LargeInteger& operator--()
      {
-        std::stringstream ss;
-        ss << std::hex;
-        
-        for( int i = 0; i < L; ++i )
-          {
-             ss << num[ i ];
-          }
-        
-        return ss.str().substr( ss.str().find_first_not_of( "0" ) );
+        *this -= 1;
+        return *this;
      }
    
-   std::string toOctString() const
+   MULTIINT_CONSTEXPR LargeInteger operator--( int )
      {
-        std::stringstream ss;
-        ss << std::oct;
-        int tmp = 0;
-        int count = (L*64)%3;
-        count = ( ( count & 1 ) << 1 ) | ( ( count >> 1 ) & 1 );
-        
-        for( int i = 0; i < L; ++i )
-          {
-             for( int j = 0; j < 64; ++j )
-               {
-                  tmp <<= 1;
-                  tmp |= ( num[ i ] >> ( 64 - j - 1 ) ) & 1;
-                  if( ++count == 3 )
-                    {
-                       ss << tmp;
-                       tmp = 0;
-                       count = 0;
-                    }
-               }
-          }
-        
-        return ss.str().substr( ss.str().find_first_not_of( "0" ) );
+        LargeInteger tmp( *this );
+        *this -= 1;
+        return tmp;
      }
-
-#if __cplusplus > CPP11VERSION
-   explicit operator uint64_t() const
+   
+   /* Three-way comparison in a single pass from the most significant limb:
+    * returns a negative value, zero or a positive value when the integer is
+    * less than, equal to or greater than b.
+    */
+   MULTIINT_CONSTEXPR int compare( const LargeInteger& b ) const
      {
-        return toUInt64();
+        if( isNegative() != b.isNegative() ) return isNegative() ? -1 : 1;
+        for( int k = 0; k < L; ++k )
+          if( num[ k ] != b.num[ k ] )
+            return num[ k ] < b.num[ k ] ? -1 : 1;
+        return 0;
      }
    
-   explicit operator int64_t() const
+   MULTIINT_CONSTEXPR bool operator==( const LargeInteger& b ) const
      {
-        return toInt64();
+#ifdef MULTIINT_SIMD
+        if( L >= MULTIINT_SIMD_THRESHOLD && !MULTIINT_IS_CONSTANT_EVALUATED() && multiint_detail::simd_level() > 0 )
+          return multiint_detail::equal_avx2( num, b.num, L );
+#endif
+        for( int k = 0; k < L; ++k ) 
+          if( num[ k ] != b.num[ k ] ) 
+            return false;
+        return true;
      }
    
-   explicit operator uint32_t() const
+   MULTIINT_CONSTEXPR bool operator!=( const LargeInteger& b ) const
      {
-        return (uint32_t)toUInt64();
+        return !( *this == b );
      }
    
-   explicit operator int32_t() const
+   MULTIINT_CONSTEXPR bool operator>( const LargeInteger& b ) const
      {
-        return (int32_t)toInt64();
+        return compare( b ) > 0;
      }
    
-   explicit operator uint16_t() const
+   MULTIINT_CONSTEXPR bool operator<( const LargeInteger& b ) const
      {
-        return (uint16_t)toUInt64();
+        return compare( b ) < 0;
      }
    
-   explicit operator int16_t() const
+   MULTIINT_CONSTEXPR bool operator>=( const LargeInteger& b ) const
      {
-        return (int16_t)toInt64();
+        return compare( b ) >= 0;
      }
    
-   explicit operator uint8_t() const
+   MULTIINT_CONSTEXPR bool operator<=( const LargeInteger& b ) const
      {
-        return (uint8_t)toUInt64();
+        return compare( b ) <= 0;
      }
    
-   explicit operator int8_t() const
+#ifdef MULTIINT_HAS_THREE_WAY_COMPARISON
+   constexpr std::strong_ordering operator<=>( const LargeInteger& b ) const
      {
-        return (int8_t)toInt64();
+        return compare( b ) <=> 0;
      }
 #endif
    
-   uint64_t toUInt64() const
+   MULTIINT_CONSTEXPR LargeInteger operator~() const
      {
-        return num[ L-1 ];
+        LargeInteger res;
+        bitwise< multiint_detail::bit_not >( res.num, num, num );
+        return res;
      }
    
-   int64_t toInt64() const
+   MULTIINT_CONSTEXPR LargeInteger operator&( const LargeInteger& b ) const
      {
-        return (int64_t)num[ L-1 ];
+        LargeInteger res;
+        bitwise< multiint_detail::bit_and >( res.num, num, b.num );
+        return res;
      }
    
-   uint32_t toUInt32() const
+   MULTIINT_CONSTEXPR LargeInteger operator|( const LargeInteger& b ) const
      {
-        return (uint32_t)toUInt64();
+        LargeInteger res;
+        bitwise< multiint_detail::bit_or >( res.num, num, b.num );
+        return res;
      }
    
-   int32_t toInt32() const
+   MULTIINT_CONSTEXPR LargeInteger operator^( const LargeInteger& b ) const
      {
-        return (int32_t)toInt64();
+        LargeInteger res;
+        bitwise< multiint_detail::bit_xor >( res.num, num, b.num );
+        return res;
      }
    
-   uint16_t toUInt16() const
+   /* *this & ~b without building ~b. */
+   MULTIINT_CONSTEXPR LargeInteger andNot( const LargeInteger& b ) const
      {
-        return (uint16_t)toUInt64();
+        LargeInteger res;
+        bitwise< multiint_detail::bit_andnot >( res.num, num, b.num );
+        return res;
      }
    
-   int16_t toInt16() const
+   /* ( *this & b ) != 0 without building the intersection. */
+   MULTIINT_CONSTEXPR bool testAny( const LargeInteger& b ) const
      {
-        return (int16_t)toInt64();
+#ifdef MULTIINT_SIMD
+        if( L >= MULTIINT_SIMD_THRESHOLD && !MULTIINT_IS_CONSTANT_EVALUATED() && multiint_detail::simd_level() > 0 )
+          return multiint_detail::test_any_avx2( num, b.num, L );
+#endif
+        return multiint_detail::test_any( num, b.num, L );
      }
    
-   uint8_t toUInt8() const
+   MULTIINT_CONSTEXPR LargeInteger operator<<( int l ) const
      {
-        return (uint8_t)toUInt64();
+        LargeInteger res;
+        if( l < W ) multiint_detail::lshift_or( res.num, num, l, NULL, L );
+        return res;
      }
    
-   int8_t toInt8() const
+   MULTIINT_CONSTEXPR LargeInteger operator>>( int r ) const
      {
-        return (int8_t)toInt64();
+        LargeInteger res;
+        uint64_t fill = isNegative() ? ~0ULL : 0;
+        multiint_detail::rshift_fill( res.num, num, r < W ? r : W, fill, L );
+        return res;
      }
    
-   bool isNegative() const
+   /* Shifts by a constant. The shift is split into limbs and bits at compile
+    * time so the limb loop is fully unrolled, with no test on the shift left.
+    */
+   template< int N > MULTIINT_CONSTEXPR LargeInteger shl() const
      {
-        return ( num[ 0 ] & ( 1LL << 63 ) ) != 0;
+        static_assert( N >= 0 && N < W, "Shift out of range" );
+        LargeInteger res;
+        multiint_detail::lshift_or( res.num, num, N, NULL, L );
+        return res;
      }
    
-   bool isPositive() const
+   template< int N > MULTIINT_CONSTEXPR LargeInteger shr() const
      {
-        for( int i = 0; i < L; ++i ) if( num[ i ] != 0 ) return true;
-        return false;
+        static_assert( N >= 0 && N < W, "Shift out of range" );
+        LargeInteger res;
+        multiint_detail::rshift_fill( res.num, num, N, isNegative() ? ~0ULL : 0, L );
+        return res;
      }
    
- private:
-   uint64_t num[ L ];
-   LargeInteger* r;
-   
-   void negate()
+   MULTIINT_CONSTEXPR LargeInteger& operator+=( const LargeInteger& b )
      {
-        for( int k = 0; k < L; ++k ) num[ k ] = ~num[ k ];
-        for( int k = L-1; k >=0; --k )
-          {
-             ++num[ k ];
-             if( num[ k ] != 0 ) break;
-          }
+        *this = *this + b;
+        return *this;
      }
    
-   void assign( int64_t i )
+   MULTIINT_CONSTEXPR LargeInteger& operator-=( const LargeInteger& b )
      {
-        for( int k = 0; k < L-1; ++k ) num[ k ] = 0;
-        if( i < 0 )
-          {
-             num[ L-1 ] = -i;
-             negate();
-          }
-        else
-          num[ L-1 ] = i;
+        *this = *this - b;
+        return *this;
      }
    
-   void assign( uint64_t i )
+   MULTIINT_CONSTEXPR LargeInteger& operator*=( const LargeInteger& b )
      {
-        for( int k = 0; k < L-1; ++k ) num[ k ] = 0;
-        num[ L-1 ] = i;
-        if( r ) delete r;
-        r = NULL;
+        *this = *this * b;
+        return *this;
      }
    
-   void parse( const std::string& s )
+   MULTIINT_CONSTEXPR LargeInteger& operator*=( uint64_t i )
      {
-        if( s.length() == 0 ) *this = 0;
-        if( s[ 0 ] == '0' )
-          {
-             if( s.length() > 1 && tolower( s[ 1 ] ) == 'x' ) parseHex( s );
-             else parseOct( s );
-             return;
-          }
-                
-        LargeInteger tmp;
-        int i = 0;
-        if( s[ 0 ] == '-' ) ++i;
-        
-        for( ; i < s.length(); ++i )
-          {
-             if( s[ i ] < '0' || s[ i ] > '9' ) throw number_format_error( "Number could not be parsed" );
-             tmp = tmp * 10 + ( s[ i ] - '0' );
-          }
-        
-        if( s[ 0 ] == '-' ) tmp.negate();
-        
-        *this = tmp;
+        *this = *this * i;
+        return *this;
      }
    
-   void parseHex( const std::string& s )
+   MULTIINT_CONSTEXPR LargeInteger& operator*=( int64_t i )
      {
-        LargeInteger tmp;
-        for( int i = 2; i < s.length(); ++i)
-          {
-             int val = 0;
-             char c = tolower( s[ i ] );
-             if( c >= '0' && c <= '9' ) val = c - '0';
-             else if( c >= 'a' && c <= 'f' ) val = 10 + c - 'a';
-             else throw number_format_error( "Number could not be parsed" );
-             
-             tmp = tmp * 16 + val;
-          }
-        
-        *this = tmp;
+        *this = *this * i;
+        return *this;
      }
    
-   void parseOct( const std::string& s )
+   MULTIINT_CONSTEXPR LargeInteger& operator*=( uint32_t i )
      {
-        LargeInteger tmp;
-        for( int i = 1; i < s.length(); ++i )
-          {
-             if( s[ i ] < '0' || s[ i ] > '7' ) throw number_format_error( "Number could not be parsed" );
-             tmp = tmp * 8 + ( s[ i ] - '0' );
-          }
-        
-        *this = tmp;
+        *this = *this * i;
+        return *this;
      }
-};
+   
+   MULTIINT_CONSTEXPR LargeInteger& operator*=( int32_t i )
+     {
+        *this = *this * i;
+        return *this;
+     }
+   
+   MULTIINT_CONSTEXPR LargeInteger& operator*=( uint16_t i )
+     {
+        *this = *this * i;
+        return *this;
+     }
+   
+   MULTIINT_CONSTEXPR LargeInteger& operator*=( int16_t i )
+     {
+        *this = *this * i;
+        return *this;
+     }
+   
+   MULTIINT_CONSTEXPR LargeInteger& operator*=( uint8_t i )
+     {
+        *this = *this * i;
+        return *this;
+     }
+   
+   MULTIINT_CONSTEXPR LargeInteger& operator*=( int8_t i )
+     {
+        *this = *this * i;
+        return *this;
+     }
+   
+   MULTIINT_CONSTEXPR LargeInteger& operator/=( const LargeInteger& b )
+     {
+        *this = *this / b;
+        return *this;
+     }
+   
+   MULTIINT_CONSTEXPR LargeInteger& operator/=( uint64_t i )
+     {
+        *this = *this / i;
+        return *this;
+     }
+   
+   MULTIINT_CONSTEXPR LargeInteger& operator/=( int64_t i )
+     {
+        *this = *this / i;
+        return *this;
+     }
+   
+   MULTIINT_CONSTEXPR LargeInteger& operator/=( uint32_t i )
+     {
+        *this = *this / i;
+        return *this;
+     }
+   
+   MULTIINT_CONSTEXPR LargeInteger& operator/=( int32_t i )
+     {
+        *this = *this / i;
+        return *this;
+     }
+   
+   MULTIINT_CONSTEXPR LargeInteger& operator/=( uint16_t i )
+     {
+        *this = *this / i;
+        return *this;
+     }
+   
+   MULTIINT_CONSTEXPR LargeInteger& operator/=( int16_t i )
+     {
+        *this = *this / i;
+        return *this;
+     }
+   
+   MULTIINT_CONSTEXPR LargeInteger& operator/=( uint8_t i )
+     {
+        *this = *this / i;
+        return *this;
+     }
+   
+   MULTIINT_CONSTEXPR LargeInteger& operator/=( int8_t i )
+     {
+        *this = *this / i;
+        return *this;
+     }
+   
+   MULTIINT_CONSTEXPR LargeInteger& operator/=( const Divisor64& d )
+     {
+        *this = *this / d;
+        return *this;
+     }
+   
+   MULTIINT_CONSTEXPR LargeInteger& operator%=( const LargeInteger& b )
+     {
+        *this = *this % b;
+        return *this;
+     }
+   
+   MULTIINT_CONSTEXPR LargeInteger& operator%=( uint64_t i )
+     {
+        *this = *this % i;
+        return *this;
+     }
+   
+   MULTIINT_CONSTEXPR LargeInteger& operator%=( int64_t i )
+     {
+        *this = *this % i;
+        return *this;
+     }
+   
+   MULTIINT_CONSTEXPR LargeInteger& operator%=( uint32_t i )
+     {
+        *this = *this % i;
+        return *this;
+     }
+   
+   MULTIINT_CONSTEXPR LargeInteger& operator%=( int32_t i )
+     {
+        *this = *this % i;
+        return *this;
+     }
+   
+   MULTIINT_CONSTEXPR LargeInteger& operator%=( uint16_t i )
+     {
+        *this = *this % i;
+        return *this;
+     }
+   
+   MULTIINT_CONSTEXPR LargeInteger& operator%=( int16_t i )
+     {
+        *this = *this % i;
+        return *this;
+     }
+   
+   MULTIINT_CONSTEXPR LargeInteger& operator%=( uint8_t i )
+     {
+        *this = *this % i;
+        return *this;
+     }
+   
+   MULTIINT_CONSTEXPR LargeInteger& operator%=( int8_t i )
+     {
+        *this = *this % i;
+        return *this;
+     }
+   
+   MULTIINT_CONSTEXPR LargeInteger& operator&=( const LargeInteger& b )
+     {
+        bitwise< multiint_detail::bit_and >( num, num, b.num );
+        return *this;
+     }
+   
+   MULTIINT_CONSTEXPR LargeInteger& operator|=( const LargeInteger& b )
+     {
+        bitwise< multiint_detail::bit_or >( num, num, b.num );
+        return *this;
+     }
+   
+   MULTIINT_CONSTEXPR LargeInteger& operator^=( const LargeInteger& b )
+     {
+        bitwise< multiint_detail::bit_xor >( num, num, b.num );
+        return *this;
+     }
+   
+   /* *this &= ~b. */
+   MULTIINT_CONSTEXPR LargeInteger& andNotAssign( const LargeInteger& b )
+     {
+        bitwise< multiint_detail::bit_andnot >( num, num, b.num );
+        return *this;
+     }
+   
+   MULTIINT_CONSTEXPR LargeInteger& operator<<=( int l )
+     {
+        if( l < W ) multiint_detail::lshift_or( num, num, l, NULL, L );
+        else *this = LargeInteger();
+        return *this;
+     }
+   
+   MULTIINT_CONSTEXPR LargeInteger& operator>>=( int l )
+     {
+        uint64_t fill = isNegative() ? ~0ULL : 0;
+        multiint_detail::rshift_fill( num, num, l < W ? l : W, fill, L );
+        return *this;
+     }
+   
+   operator std::string() const
+     {
+        /* The digits are taken from the limbs of the magnitude seen as an
+         * unsigned value, which also covers the most negative value.
+         */
+        LargeInteger tmp = *this;
+        if( isNegative() ) tmp.negate();
+        int top = L - tmp.significantLimbs();
+        if( top == L ) return "0";
+        
+        std::string s;
+        if( isNegative() ) s += '-';
+        multiint_detail::append_decimal( s, tmp.num + top, L - top );
+        return s;
+     }
+   
+   std::string toHexString() const
+     {
+        int top = L - significantLimbs();
+        if( top == L ) return "0";
+        
+        std::stringstream ss;
+        ss << std::hex << num[ top ] << std::setfill( '0' );
+        
+        for( int i = top + 1; i < L; ++i )
+          {
+             ss << std::setw( 16 ) << num[ i ];
+          }
+        
+        return ss.str();
+     }
+   
+   std::string toOctString() const
+     {
+        int top = L - significantLimbs();
+        if( top == L ) return "0";
+        
+        std::stringstream ss;
+        ss << std::oct;
+        int tmp = 0;
+        int count = ((L-top)*64)%3;
+        count = ( ( count & 1 ) << 1 ) | ( ( count >> 1 ) & 1 );
+        
+        for( int i = top; i < L; ++i )
+          {
+             for( int j = 0; j < 64; ++j )
+               {
+                  tmp <<= 1;
+                  tmp |= ( num[ i ] >> ( 64 - j - 1 ) ) & 1;
+                  if( ++count == 3 )
+                    {
+                       ss << tmp;
+                       tmp = 0;
+                       count = 0;
+                    }
+               }
+          }
+        
+        return ss.str().substr( ss.str().find_first_not_of( "0" ) );
+     }
+
+#if __cplusplus > CPP11VERSION
+   explicit MULTIINT_CONSTEXPR operator uint64_t() const
+     {
+        return toUInt64();
+     }
+   
+   explicit MULTIINT_CONSTEXPR operator int64_t() const
+     {
+        return toInt64();
+     }
+   
+   explicit MULTIINT_CONSTEXPR operator uint32_t() const
+     {
+        return (uint32_t)toUInt64();
+     }
+   
+   explicit MULTIINT_CONSTEXPR operator int32_t() const
+     {
+        return (int32_t)toInt64();
+     }
+   
+   explicit MULTIINT_CONSTEXPR operator uint16_t() const
+     {
+        return (uint16_t)toUInt64();
+     }
+   
+   explicit MULTIINT_CONSTEXPR operator int16_t() const
+     {
+        return (int16_t)toInt64();
+     }
+   
+   explicit MULTIINT_CONSTEXPR operator uint8_t() const
+     {
+        return (uint8_t)toUInt64();
+     }
+   
+   explicit MULTIINT_CONSTEXPR operator int8_t() const
+     {
+        return (int8_t)toInt64();
+     }
+#endif
+   
+   MULTIINT_CONSTEXPR uint64_t toUInt64() const
+     {
+        return num[ L-1 ];
+     }
+   
+   MULTIINT_CONSTEXPR int64_t toInt64() const
+     {
+        return (int64_t)num[ L-1 ];
+     }
+   
+   MULTIINT_CONSTEXPR uint32_t toUInt32() const
+     {
+        return (uint32_t)toUInt64();
+     }
+   
+   MULTIINT_CONSTEXPR int32_t toInt32() const
+     {
+        return (int32_t)toInt64();
+     }
+   
+   MULTIINT_CONSTEXPR uint16_t toUInt16() const
+     {
+        return (uint16_t)toUInt64();
+     }
+   
+   MULTIINT_CONSTEXPR int16_t toInt16() const
+     {
+        return (int16_t)toInt64();
+     }
+   
+   MULTIINT_CONSTEXPR uint8_t toUInt8() const
+     {
+        return (uint8_t)toUInt64();
+     }
+   
+   MULTIINT_CONSTEXPR int8_t toInt8() const
+     {
+        return (int8_t)toInt64();
+     }
+   
+   MULTIINT_CONSTEXPR bool isNegative() const
+     {
+        return S && ( num[ 0 ] & ( 1ULL << 63 ) ) != 0;
+     }
+   
+   MULTIINT_CONSTEXPR bool isPositive() const
+     {
+#ifdef MULTIINT_SIMD
+        if( L >= MULTIINT_SIMD_THRESHOLD && !MULTIINT_IS_CONSTANT_EVALUATED() && multiint_detail::simd_level() > 0 )
+          return multiint_detail::test_any_avx2( num, NULL, L );
+#endif
+        return multiint_detail::test_any( num, NULL, L );
+     }
+   
+   /* Access to single bits of the two's complement representation, bit 0
+    * being the least significant one. i must be between 0 and W-1.
+    */
+   MULTIINT_CONSTEXPR bool testBit( int i ) const
+     {
+        return ( num[ L-1 - i/64 ] >> ( i%64 ) ) & 1;
+     }
+   
+   MULTIINT_CONSTEXPR LargeInteger& setBit( int i )
+     {
+        num[ L-1 - i/64 ] |= 1ULL << ( i%64 );
+        return *this;
+     }
+   
+   MULTIINT_CONSTEXPR LargeInteger& clearBit( int i )
+     {
+        num[ L-1 - i/64 ] &= ~( 1ULL << ( i%64 ) );
+        return *this;
+     }
+   
+   MULTIINT_CONSTEXPR LargeInteger& flipBit( int i )
+     {
+        num[ L-1 - i/64 ] ^= 1ULL << ( i%64 );
+        return *this;
+     }
+   
+   /* Number of bits of the value without its sign, that is the position of
+    * the highest bit that differs from the sign plus one. 0 for 0 and -1.
+    */
+   MULTIINT_CONSTEXPR int bitLength() const
+     {
+        if( !isNegative() ) return significantBits();
+        int k = 0;
+        while( k < L && num[ k ] == ~0ULL ) ++k;
+        return k < L ? 64 * ( L-k ) - multiint_detail::clz_1( ~num[ k ] ) : 0;
+     }
+   
+   /* The following ones work on the raw W bits, as for an unsigned value:
+    * a negative value has no leading zero and its set bits include the
+    * sign extension. Zero has W leading and trailing zeros.
+    */
+   MULTIINT_CONSTEXPR int countLeadingZeros() const
+     {
+        return W - significantBits();
+     }
+   
+   MULTIINT_CONSTEXPR int countTrailingZeros() const
+     {
+        for( int k = L-1; k >= 0; --k )
+          if( num[ k ] ) return 64 * ( L-1 - k ) + multiint_detail::ctz_1( num[ k ] );
+        return W;
+     }
+   
+   MULTIINT_CONSTEXPR int popCount() const
+     {
+        int res = 0;
+        for( int k = 0; k < L; ++k ) res += multiint_detail::popcount_1( num[ k ] );
+        return res;
+     }
+   
+   /* The n bits starting at bit pos, n being at most 64, as *this >> pos
+    * would give them. Bits above W are copies of the sign.
+    */
+   MULTIINT_CONSTEXPR uint64_t extractBits( int pos, int n ) const
+     {
+        uint64_t fill = isNegative() ? ~0ULL : 0;
+        int k = pos / 64;
+        int b = pos % 64;
+        uint64_t lo = k < L ? num[ L-1 - k ] : fill;
+        uint64_t hi = k+1 < L ? num[ L-2 - k ] : fill;
+        uint64_t v = b ? ( lo >> b ) | ( hi << ( 64 - b ) ) : lo;
+        return n < 64 ? v & ( ( 1ULL << n ) - 1 ) : v;
+     }
+   
+   /* Raw access to the limbs, most significant limb first. */
+   MULTIINT_CONSTEXPR const uint64_t* limbs() const
+     {
+        return num;
+     }
+   
+   MULTIINT_CONSTEXPR uint64_t* limbs()
+     {
+        return num;
+     }
+   
+ private:
+   uint64_t num[ L ];
+   
+   /* The magnitude of the value: the value itself when it is not negative,
+    * otherwise its negation stored in tmp. Nothing is copied for unsigned
+    * integers.
+    */
+   MULTIINT_CONSTEXPR const LargeInteger& magnitude( LargeInteger& tmp ) const
+     {
+        if( !isNegative() ) return *this;
+        tmp = *this;
+        tmp.negate();
+        return tmp;
+     }
+   
+   /* r = a op b on the L limbs, with the SIMD kernels for wide integers. r
+    * may be the same array as a or b.
+    */
+   template< int Op > static MULTIINT_CONSTEXPR void bitwise( uint64_t* r, const uint64_t* a, const uint64_t* b )
+     {
+#ifdef MULTIINT_SIMD
+        if( L >= MULTIINT_SIMD_THRESHOLD && !MULTIINT_IS_CONSTANT_EVALUATED() && multiint_detail::simd_level() > 0 )
+          {
+             multiint_detail::bitop_simd< Op >( r, a, b, L );
+             return;
+          }
+#endif
+        multiint_detail::bitop_n< Op >( r, a, b, L );
+     }
+   
+   /* Smallest number of limbs the value can be sign extended from, that is
+    * the significant limbs plus the sign. 0 for zero.
+    */
+   MULTIINT_CONSTEXPR int signedLimbs() const
+     {
+        if( !isNegative() )
+          {
+             int n = significantLimbs();
+             return S && n && ( num[ L - n ] >> 63 ) ? n + 1 : n;
+          }
+        int k = 0;
+        while( k < L-1 && num[ k ] == ~0ULL && ( num[ k+1 ] >> 63 ) ) ++k;
+        return L - k;
+     }
+   
+   /* Truncated product of a and b, given as their na and nb least
+    * significant limbs, sign extended when sa or sb is set. The product is
+    * computed directly on the two's complement limbs: the unsigned product
+    * of the limbs is corrected by subtracting b from its high limbs when a
+    * is negative and a when b is negative. As the exact result fits in
+    * na + nb limbs, it is then sign extended to the width of the integer.
+    */
+   static MULTIINT_CONSTEXPR LargeInteger product( const uint64_t* ap, int na, bool sa, const uint64_t* bp, int nb, bool sb )
+     {
+        LargeInteger res;
+        if( na == 0 || nb == 0 ) return res;
+        if( L == 1 )
+          {
+             res.num[ 0 ] = ap[ 0 ] * bp[ 0 ];
+             return res;
+          }
+        if( na == 1 )
+          {
+             const uint64_t* p = ap; ap = bp; bp = p;
+             int n = na; na = nb; nb = n;
+             bool s = sa; sa = sb; sb = s;
+          }
+        
+        int n = na + nb;
+        if( nb == 1 && n > L )
+          {
+             multiint_detail::muladd_1( res.num, ap, bp[ 0 ], 0, L );
+             if( sb ) multiint_detail::sub_n( res.num, res.num, ap + 1, L-1 );
+          }
+        else if( nb == 1 )
+          {
+             uint64_t* rp = res.num + L - n;
+             rp[ 0 ] = multiint_detail::muladd_1( rp + 1, ap, bp[ 0 ], 0, na );
+             if( sa ) rp[ 0 ] -= bp[ 0 ];
+             if( sb ) multiint_detail::sub_n( rp, rp, ap, na );
+          }
+        else if( n <= L )
+          {
+             uint64_t* rp = res.num + L - n;
+             multiint_detail::mul_n( rp, ap, na, bp, nb );
+             if( sa ) multiint_detail::sub_n( rp, rp, bp, nb );
+             if( sb ) multiint_detail::sub_n( rp, rp, ap, na );
+          }
+        else
+          {
+             multiint_detail::mullo_n( res.num, ap, na, bp, nb, L );
+             if( sa && na < L ) multiint_detail::sub_n( res.num, res.num, bp + nb - ( L - na ), L - na );
+             if( sb && nb < L ) multiint_detail::sub_n( res.num, res.num, ap + na - ( L - nb ), L - nb );
+          }
+        
+        if( ( sa || sb ) && n < L && ( res.num[ L - n ] >> 63 ) )
+          for( int k = 0; k < L - n; ++k ) res.num[ k ] = ~0ULL;
+        return res;
+     }
+   
+   /* Number of limbs up to the most significant non zero one, 0 for zero.
+    * The loops working on magnitudes only go through these limbs.
+    */
+   MULTIINT_CONSTEXPR int significantLimbs() const
+     {
+        int k = 0;
+        while( k < L && num[ k ] == 0 ) ++k;
+        return L - k;
+     }
+   
+   /* Position of the most significant bit set plus one, 0 for zero. */
+   MULTIINT_CONSTEXPR int significantBits() const
+     {
+        int n = significantLimbs();
+        return n ? 64 * n - multiint_detail::clz_1( num[ L - n ] ) : 0;
+     }
+   
+   MULTIINT_CONSTEXPR void negate()
+     {
+        for( int k = 0; k < L; ++k ) num[ k ] = ~num[ k ];
+        for( int k = L-1; k >=0; --k )
+          {
+             ++num[ k ];
+             if( num[ k ] != 0 ) break;
+          }
+     }
+   
+   MULTIINT_CONSTEXPR void assign( int64_t i )
+     {
+        for( int k = 0; k < L-1; ++k ) num[ k ] = 0;
+        if( i < 0 )
+          {
+             num[ L-1 ] = -(uint64_t)i;
+             negate();
+          }
+        else
+          num[ L-1 ] = i;
+     }
+   
+   MULTIINT_CONSTEXPR void assign( uint64_t i )
+     {
+        for( int k = 0; k < L-1; ++k ) num[ k ] = 0;
+        num[ L-1 ] = i;
+     }
+   
+   void parse( const std::string& s )
+     {
+        if( s.length() == 0 ) *this = 0;
+        if( s[ 0 ] == '0' )
+          {
+             if( s.length() > 1 && tolower( s[ 1 ] ) == 'x' ) parseHex( s );
+             else parseOct( s );
+             return;
+          }
+                
+        LargeInteger tmp;
+        int i = 0;
+        if( s[ 0 ] == '-' ) ++i;
+        
+        for( ; i < s.length(); ++i )
+          {
+             if( s[ i ] < '0' || s[ i ] > '9' ) throw number_format_error( "Number could not be parsed" );
+             multiint_detail::muladd_1( tmp.num, tmp.num, 10, s[ i ] - '0', L );
+          }
+        
+        if( s[ 0 ] == '-' ) tmp.negate();
+        
+        *this = tmp;
+     }
+   
+   void parseHex( const std::string& s )
+     {
+        LargeInteger tmp;
+        for( int i = 2; i < s.length(); ++i)
+          {
+             int val = 0;
+             char c = tolower( s[ i ] );
+             if( c >= '0' && c <= '9' ) val = c - '0';
+             else if( c >= 'a' && c <= 'f' ) val = 10 + c - 'a';
+             else throw number_format_error( "Number could not be parsed" );
+             
+             multiint_detail::muladd_1( tmp.num, tmp.num, 16, val, L );
+          }
+        
+        *this = tmp;
+     }
+   
+   void parseOct( const std::string& s )
+     {
+        LargeInteger tmp;
+        for( int i = 1; i < s.length(); ++i )
+          {
+             if( s[ i ] < '0' || s[ i ] > '7' ) throw number_format_error( "Number could not be parsed" );
+             multiint_detail::muladd_1( tmp.num, tmp.num, 8, s[ i ] - '0', L );
+          }
+        
+        *this = tmp;
+     }
+};
+
+/* What the division operators return: the quotient, which it can be used
+ * as, along with the remainder of the division. The remainder is kept by
+ * value so a division never allocates and LargeInteger stays a literal type.
+ */
+template< int W, typename u128, bool S > class DivisionResult : public LargeInteger< W, u128, S >
+{
+   typedef LargeInteger< W, u128, S > Integer;
+   
+ public:
+   MULTIINT_CONSTEXPR DivisionResult( const LargeInteger< W, u128, S >& q, const LargeInteger< W, u128, S >& r )
+     : LargeInteger< W, u128, S >( q ), r( r )
+       {
+       }
+   
+   MULTIINT_CONSTEXPR const LargeInteger< W, u128, S >& getRemaining() const
+     {
+        return r;
+     }
+   
+   /* Changing the quotient resets the remainder to zero, as it would no
+    * longer match the division.
+    */
+   MULTIINT_CONSTEXPR DivisionResult& operator=( const LargeInteger< W, u128, S >& q )
+     {
+        Integer::operator=( q );
+        return reset();
+     }
+   
+   template< class T > MULTIINT_CONSTEXPR DivisionResult& operator+=( const T& x )
+     {
+        Integer::operator+=( x );
+        return reset();
+     }
+   
+   template< class T > MULTIINT_CONSTEXPR DivisionResult& operator-=( const T& x )
+     {
+        Integer::operator-=( x );
+        return reset();
+     }
+   
+   template< class T > MULTIINT_CONSTEXPR DivisionResult& operator*=( const T& x )
+     {
+        Integer::operator*=( x );
+        return reset();
+     }
+   
+   template< class T > MULTIINT_CONSTEXPR DivisionResult& operator/=( const T& x )
+     {
+        Integer::operator/=( x );
+        return reset();
+     }
+   
+   template< class T > MULTIINT_CONSTEXPR DivisionResult& operator%=( const T& x )
+     {
+        Integer::operator%=( x );
+        return reset();
+     }
+   
+   template< class T > MULTIINT_CONSTEXPR DivisionResult& operator&=( const T& x )
+     {
+        Integer::operator&=( x );
+        return reset();
+     }
+   
+   template< class T > MULTIINT_CONSTEXPR DivisionResult& operator|=( const T& x )
+     {
+        Integer::operator|=( x );
+        return reset();
+     }
+   
+   template< class T > MULTIINT_CONSTEXPR DivisionResult& operator^=( const T& x )
+     {
+        Integer::operator^=( x );
+        return reset();
+     }
+   
+   MULTIINT_CONSTEXPR DivisionResult& operator<<=( int l )
+     {
+        Integer::operator<<=( l );
+        return reset();
+     }
+   
+   MULTIINT_CONSTEXPR DivisionResult& operator>>=( int l )
+     {
+        Integer::operator>>=( l );
+        return reset();
+     }
+   
+   MULTIINT_CONSTEXPR DivisionResult& operator++()
+     {
+        Integer::operator++();
+        return reset();
+     }
+   
+   MULTIINT_CONSTEXPR Integer operator++( int )
+     {
+        Integer tmp( *this );
+        ++*this;
+        return tmp;
+     }
+   
+   MULTIINT_CONSTEXPR DivisionResult& operator--()
+     {
+        Integer::operator--();
+        return reset();
+     }
+   
+   MULTIINT_CONSTEXPR Integer operator--( int )
+     {
+        Integer tmp( *this );
+        --*this;
+        return tmp;
+     }
+   
+ private:
+   Integer r;
+   
+   MULTIINT_CONSTEXPR DivisionResult& reset()
+     {
+        r = Integer();
+        return *this;
+     }
+};
+
+/* Opt-in expression templates. Wrapping an operand with lazy() makes the
+ * operators below build a small expression tree instead of computing full
+ * width temporaries at each step. The tree is evaluated in one pass over the
+ * limbs when it is assigned to an integer or when eval() is called:
+ *
+ *   x = lazy( a ) * 10 + b;        // single addmul_1 pass
+ *   x = lazy( a ) * b + c;         // schoolbook product accumulated into c
+ *   x = ( lazy( a ) << 67 ) | b;   // single shift-or pass
+ *
+ * Expressions only hold references to their operands so they must be
+ * evaluated before the end of the full expression that created them.
+ */
+template< class E > class IntegerExpression
+{
+ public:
+   const E& self() const
+     {
+        return static_cast< const E& >( *this );
+     }
+};
+
+template< class I > class MulAddExpression;
+template< class I > class ProductSumExpression;
+template< class I > class ShiftOrExpression;
+
+/* a * k where k is a single limb. */
+template< class I > class ScaledExpression : public IntegerExpression< ScaledExpression< I > >
+{
+ public:
+   ScaledExpression( const I& a, uint64_t k, bool neg ) : a( a ), k( k ), neg( neg )
+     {
+     }
+   
+   MulAddExpression< I > operator+( const I& b ) const
+     {
+        return MulAddExpression< I >( a, k, neg, b );
+     }
+   
+   void evalTo( I& res ) const
+     {
+        multiint_detail::muladd_1( res.limbs(), a.limbs(), k, 0, I::L );
+        if( neg ) res = -res;
+     }
+   
+   I eval() const
+     {
+        return I( *this );
+     }
+   
+ private:
+   const I& a;
+   uint64_t k;
+   bool neg;
+};
+
+/* b + a * k where k is a single limb, the multiply-add of parse(). */
+template< class I > class MulAddExpression : public IntegerExpression< MulAddExpression< I > >
+{
+ public:
+   MulAddExpression( const I& a, uint64_t k, bool neg, const I& b ) : a( a ), k( k ), neg( neg ), b( b )
+     {
+     }
+   
+   void evalTo( I& res ) const
+     {
+        if( neg ) multiint_detail::submul_1( res.limbs(), a.limbs(), k, b.limbs(), I::L );
+        else multiint_detail::addmul_1( res.limbs(), a.limbs(), k, b.limbs(), I::L );
+     }
+   
+   I eval() const
+     {
+        return I( *this );
+     }
+   
+ private:
+   const I& a;
+   uint64_t k;
+   bool neg;
+   const I& b;
+};
+
+/* c + a * b, the product being truncated to the width of the integer like
+ * the regular operator*. Each limb of b is multiplied and added in place
+ * into the result so no shifted partial product is ever built.
+ */
+template< class I > class ProductSumExpression : public IntegerExpression< ProductSumExpression< I > >
+{
+ public:
+   ProductSumExpression( const I& a, const I& b, const I* c ) : a( a ), b( b ), c( c )
+     {
+     }
+   
+   void evalTo( I& res ) const
+     {
+        if( &res == &a || &res == &b )
+          {
+             I tmp;
+             evalTo( tmp );
+             res = tmp;
+             return;
+          }
+        
+        if( c ) res = *c;
+        else res = I();
+        
+        const uint64_t* an = a.limbs();
+        const uint64_t* bn = b.limbs();
+        uint64_t* rn = res.limbs();
+        for( int j = 0; j < I::L; ++j )
+          {
+             uint64_t k = bn[ I::L-1 - j ];
+             if( k ) multiint_detail::addmul_1( rn, an + j, k, rn, I::L - j );
+          }
+     }
+   
+   I eval() const
+     {
+        return I( *this );
+     }
+   
+ private:
+   const I& a;
+   const I& b;
+   const I* c;
+};
+
+/* a * b, see ProductSumExpression. */
+template< class I > class ProductExpression : public IntegerExpression< ProductExpression< I > >
+{
+ public:
+   ProductExpression( const I& a, const I& b ) : a( a ), b( b )
+     {
+     }
+   
+   ProductSumExpression< I > operator+( const I& c ) const
+     {
+        return ProductSumExpression< I >( a, b, &c );
+     }
+   
+   void evalTo( I& res ) const
+     {
+        ProductSumExpression< I >( a, b, NULL ).evalTo( res );
+     }
+   
+   I eval() const
+     {
+        return I( *this );
+     }
+   
+ private:
+   const I& a;
+   const I& b;
+};
+
+/* ( x << s ) | y computed in a single pass. */
+template< class I > class ShiftOrExpression : public IntegerExpression< ShiftOrExpression< I > >
+{
+ public:
+   ShiftOrExpression( const I& x, int s, const I* y ) : x( x ), s( s ), y( y )
+     {
+     }
+   
+   void evalTo( I& res ) const
+     {
+        if( s >= I::L * 64 )
+          {
+             if( y ) res = *y;
+             else res = I();
+             return;
+          }
+        multiint_detail::lshift_or( res.limbs(), x.limbs(), s, y ? y->limbs() : NULL, I::L );
+     }
+   
+   I eval() const
+     {
+        return I( *this );
+     }
+   
+ private:
+   const I& x;
+   int s;
+   const I* y;
+};
+
+/* x << s, see ShiftOrExpression. */
+template< class I > class ShiftExpression : public IntegerExpression< ShiftExpression< I > >
+{
+ public:
+   ShiftExpression( const I& x, int s ) : x( x ), s( s )
+     {
+     }
+   
+   ShiftOrExpression< I > operator|( const I& y ) const
+     {
+        return ShiftOrExpression< I >( x, s, &y );
+     }
+   
+   void evalTo( I& res ) const
+     {
+        ShiftOrExpression< I >( x, s, NULL ).evalTo( res );
+     }
+   
+   I eval() const
+     {
+        return I( *this );
+     }
+   
+ private:
+   const I& x;
+   int s;
+};
+
+/* Leaf of the expression trees, see lazy(). */
+template< class I > class LazyInteger : public IntegerExpression< LazyInteger< I > >
+{
+ public:
+   explicit LazyInteger( const I& a ) : a( a )
+     {
+     }
+   
+   ScaledExpression< I > operator*( uint64_t k ) const
+     {
+        return ScaledExpression< I >( a, k, false );
+     }
+   
+   ScaledExpression< I > operator*( int64_t k ) const
+     {
+        return k < 0 ? ScaledExpression< I >( a, -(uint64_t)k, true ) : ScaledExpression< I >( a, k, false );
+     }
+   
+   ScaledExpression< I > operator*( uint32_t k ) const
+     {
+        return *this * (uint64_t)k;
+     }
+   
+   ScaledExpression< I > operator*( int32_t k ) const
+     {
+        return *this * (int64_t)k;
+     }
+   
+   ProductExpression< I > operator*( const I& b ) const
+     {
+        return ProductExpression< I >( a, b );
+     }
+   
+   ProductExpression< I > operator*( const LazyInteger& b ) const
+     {
+        return ProductExpression< I >( a, b.a );
+     }
+   
+   ShiftExpression< I > operator<<( int s ) const
+     {
+        return ShiftExpression< I >( a, s );
+     }
+   
+   void evalTo( I& res ) const
+     {
+        res = a;
+     }
+   
+   I eval() const
+     {
+        return a;
+     }
+   
+ private:
+   const I& a;
+};
+
+template< int W, typename u128, bool S > LazyInteger< LargeInteger< W, u128, S > > lazy( const LargeInteger< W, u128, S >& a )
+{
+   return LazyInteger< LargeInteger< W, u128, S > >( a );
+}
+
+template< int W, typename u128, bool S, typename l > MULTIINT_CONSTEXPR typename std::enable_if< std::is_integral< l >::value, LargeInteger< W, u128, S > >::type
+operator+( l i, const LargeInteger< W, u128, S >& j )
+{
+   return j + i;
+}
+
+template< int W, typename u128, bool S, typename l > MULTIINT_CONSTEXPR typename std::enable_if< std::is_integral< l >::value, LargeInteger< W, u128, S > >::type
+operator-( l i, const LargeInteger< W, u128, S >& j )
+{
+   return -j + i;
+}
+
+template< int W, typename u128, bool S, typename l > MULTIINT_CONSTEXPR typename std::enable_if< std::is_integral< l >::value, LargeInteger< W, u128, S > >::type
+operator*( l i, const LargeInteger< W, u128, S >& j )
+{
+   return j * i;
+}
+
+template< int W, typename u128, bool S, typename l > MULTIINT_CONSTEXPR typename std::enable_if< std::is_integral< l >::value, LargeInteger< W, u128, S > >::type
+operator/( l i, const LargeInteger< W, u128, S >& j )
+{
+   return LargeInteger< W, u128, S >( i ) / j;
+}
+
+template< int W, typename u128, bool S, typename l > MULTIINT_CONSTEXPR typename std::enable_if< std::is_integral< l >::value, l >::type
+operator%( l i, const LargeInteger< W, u128, S >& j )
+{
+   return (l)(LargeInteger< W, u128, S >( i ) % j).toUInt64();
+}
+
+template< int W, typename u128, bool S > std::ostream& operator<<( std::ostream& os, const LargeInteger< W, u128, S >& i )
+{
+   std::string prefix;
+   std::string number;
+   
+   if( ( os.flags() & os.basefield ) == os.dec )
+     {
+        if( ( os.flags() & os.showpos ) && !i.isNegative() ) prefix = "+";
+        number = ( std::string )i;
+        if( i.isNegative() )
+          {
+             prefix = "-";
+             number = number.substr( 1 );
+          }
+     }
+   else if( ( os.flags() & os.basefield ) == os.hex )
+     {
+        if( os.flags() & os.showbase ) prefix = "0x";
+        number = i.toHexString();
+        if( os.flags() & os.uppercase )
+          {
+             if( prefix.length() ) prefix = "0X";
+             std::transform( number.begin(), number.end(), number.begin(), ::toupper );
+          }
+     }
+   else if( ( os.flags() & os.basefield ) == os.oct )
+     {
+        if( os.flags() & os.showbase ) number = "0";
+        number += i.toOctString();
+     }
+   
+   if( os.width() > prefix.length() + number.length() )
+     {
+        std::string sfill( os.width() - prefix.length() - number.length(), os.fill() );
+        
+        if( ( os.flags() & os.adjustfield ) == os.internal )
+          os << ( prefix + sfill + number );
+        else if( ( os.flags() & os.adjustfield ) == os.left )
+          os << ( prefix + number + sfill );
+        else if( ( os.flags() & os.adjustfield ) == os.right )
+          os << ( sfill + prefix + number );
+     }
+   else
+     {
+        os << ( prefix + number );
+     }
+   
+   return os;
+}
+
+template< int W, typename u128, bool S > std::istream& operator>>( std::istream& is, LargeInteger< W, u128, S >& i )
+{
+   std::istream::sentry sen( is, false );
+   if( sen )
+     {
+        std::string s;
+        if( ( is.flags() & is.basefield ) == is.dec )
+          {
+             if( is.good() )
+               {
+                  if( is.peek() == '-' )
+                    {
+                       char c = is.get();
+                       s += c;
+                    }
+                  else if( is.peek() == '+' ) is.get();
+               }
+             while( is.good() )
+               {
+                  char c = is.peek();
+                  if( c == EOF ) break;
+                  if( c >= '0' && c <= '9' ) s += c;
+                  else break;
+                  is.get();
+               }
+             i = s;
+          }
+        else if( ( is.flags() & is.basefield ) == is.hex )
+          {
+             s = "0x";
+             if( is.good() && is.peek() == '0' )
+               {
+                  is.get();
+                  if( is.good() && is.peek() == 'x' ) is.get();
+                  else s += '0';
+               }
+             while( is.good() )
+               {
+                  char c = is.peek();
+                  if( c == EOF ) break;
+                  if( c >= '0' && c <= '9' ) s += c;
+                  else if( tolower(c) >= 'a' && tolower(c) <= 'z' ) s += c;
+                  else break;
+                  is.get();
+               }
+             i = s;
+          }
+        else if( ( is.flags() & is.basefield ) == is.oct )
+          {
+             s = "0";
+             if( is.good() && is.peek() == '0' )
+               is.get();
+             while( is.good() )
+               {
+                  char c = is.peek();
+                  if( c == EOF ) break;
+                  if( c >= '0' && c <= '7' ) s += c;
+                  else break;
+                  is.get();
+               }
+             i = s;
+          }
+     }
+   
+   return is;
+}
+
+template< int W > using UnsignedLargeInteger = LargeInteger< W, uint128_t, false >;
+
+/* Full product of a and b, in an integer of twice the width so it is
+ * never truncated.
+ */
+template< int W, typename u128, bool S > MULTIINT_CONSTEXPR LargeInteger< 2*W, u128, S > mulWide( const LargeInteger< W, u128, S >& a, const LargeInteger< W, u128, S >& b )
+{
+   const int L = LargeInteger< W, u128, S >::L;
+   LargeInteger< W, u128, S > ma = a.isNegative() ? -a : a;
+   LargeInteger< W, u128, S > mb = b.isNegative() ? -b : b;
+   int na = ( ma.bitLength() + ( ma.isNegative() ? 1 : 0 ) + 63 ) / 64;
+   int nb = ( mb.bitLength() + ( mb.isNegative() ? 1 : 0 ) + 63 ) / 64;
+   
+   LargeInteger< 2*W, u128, S > res;
+   if( na && nb ) multiint_detail::mul_n( res.limbs() + 2*L - na - nb, ma.limbs() + L - na, na, mb.limbs() + L - nb, nb );
+   return a.isNegative() != b.isNegative() ? -res : res;
+}
+
+/* Number theoretic functions. They work on the magnitudes of their
+ * arguments, held in unsigned integers of the same width, so the most
+ * negative value is handled as well.
+ */
+namespace multiint_detail
+{
+   template< int W, typename u128, bool S > LargeInteger< W, u128, false > magnitude_of( const LargeInteger< W, u128, S >& x )
+     {
+        LargeInteger< W, u128, false > res;
+        std::copy( x.limbs(), x.limbs() + x.L, res.limbs() );
+        return x.isNegative() ? -res : res;
+     }
+   
+   template< class I, int W, typename u128 > I with_sign( const LargeInteger< W, u128, false >& m, bool neg )
+     {
+        I res;
+        std::copy( m.limbs(), m.limbs() + m.L, res.limbs() );
+        return neg ? -res : res;
+     }
+   
+   /* Binary (Stein) GCD: only shifts and subtractions, the fastest for a few
+    * limbs.
+    */
+   template< class U > U binary_gcd( U a, U b )
+     {
+        if( !a.isPositive() ) return b;
+        if( !b.isPositive() ) return a;
+        int za = a.countTrailingZeros();
+        int zb = b.countTrailingZeros();
+        a >>= za;
+        b >>= zb;
+        while( true )
+          {
+             int c = a.compare( b );
+             if( c == 0 ) break;
+             if( c > 0 ) std::swap( a, b );
+             b -= a;
+             b >>= b.countTrailingZeros();
+          }
+        return a << ( za < zb ? za : zb );
+     }
+   
+   /* r = x * a + y * b, or x * a - y * b when sub is set, modulo 2^W. Only
+    * the n low limbs are computed, the result must fit in them.
+    */
+   template< class U > void lin_comb( U& r, const U& x, uint64_t a, const U& y, uint64_t b, bool sub, int n = U::L )
+     {
+        U t;
+        int k = U::L - n;
+        muladd_1( t.limbs() + k, x.limbs() + k, a, 0, n );
+        if( sub ) submul_1( t.limbs() + k, y.limbs() + k, b, t.limbs() + k, n );
+        else addmul_1( t.limbs() + k, y.limbs() + k, b, t.limbs() + k, n );
+        r = t;
+     }
+   
+   /* A Bezout cofactor in the extended Euclid algorithm: its magnitude and
+    * its sign. Cofactors of consecutive remainders have opposite signs.
+    */
+   template< class U > struct Cofactor
+   {
+      U m;
+      bool neg;
+   };
+   
+   /* c0' = a * c0 + b * c1, a and b having opposite signs as c0 and c1
+    * do, so both products have the same sign and the magnitudes add up.
+    */
+   template< class U > Cofactor< U > combine( const Cofactor< U >& c0, int64_t a, const Cofactor< U >& c1, int64_t b )
+     {
+        Cofactor< U > res;
+        uint64_t ua = a < 0 ? -(uint64_t)a : a;
+        uint64_t ub = b < 0 ? -(uint64_t)b : b;
+        lin_comb( res.m, c0.m, ua, c1.m, ub, false );
+        if( a != 0 && c0.m.isPositive() ) res.neg = ( a < 0 ) != c0.neg;
+        else res.neg = ( b < 0 ) != c1.neg;
+        return res;
+     }
+   
+   /* Euclid's algorithm with Lehmer's acceleration (Knuth algorithm L). The
+    * quotients are computed on the leading 62 bits of both remainders, as
+    * long as they are certainly right, and the accumulated 2x2 matrix of
+    * single limb cofactors is then applied to the full remainders in one
+    * pass. A full division is only done when the first quotient is already
+    * uncertain. When s is not NULL, the cofactors of both inputs are kept
+    * along: on return s and t hold them, with a * s + b * t = gcd.
+    */
+   template< int W, typename u128 > LargeInteger< W, u128, false > lehmer_gcd( LargeInteger< W, u128, false > a, LargeInteger< W, u128, false > b,
+                                                                                Cofactor< LargeInteger< W, u128, false > >* s,
+                                                                                Cofactor< LargeInteger< W, u128, false > >* t )
+     {
+        typedef LargeInteger< W, u128, false > U;
+        Cofactor< U > as = { U( 1 ), false }, bs = { U(), false };
+        Cofactor< U > at = { U(), false }, bt = { U( 1 ), false };
+        if( a < b )
+          {
+             std::swap( a, b );
+             std::swap( as, at );
+             std::swap( bs, bt );
+          }
+        
+        while( b.isPositive() )
+          {
+             int n = a.bitLength();
+             int shift = n > 62 ? n - 62 : 0;
+             int64_t ah = a.extractBits( shift, 62 );
+             int64_t bh = b.extractBits( shift, 62 );
+             int64_t A = 1, B = 0, C = 0, D = 1;
+             while( bh + C != 0 && bh + D != 0 )
+               {
+                  int64_t q = ( ah + A ) / ( bh + C );
+                  if( q != ( ah + B ) / ( bh + D ) ) break;
+                  int64_t T = A - q * C; A = C; C = T;
+                  T = B - q * D; B = D; D = T;
+                  T = ah - q * bh; ah = bh; bh = T;
+               }
+             
+             if( B == 0 )
+               {
+                  DivisionResult< W, u128, false > q = a / b;
+                  a = b;
+                  b = q.getRemaining();
+                  if( s )
+                    {
+                       Cofactor< U > c = { as.m + q * bs.m, as.m.isPositive() ? as.neg : !bs.neg };
+                       as = bs; bs = c;
+                       c.m = at.m + q * bt.m;
+                       c.neg = at.m.isPositive() ? at.neg : !bt.neg;
+                       at = bt; bt = c;
+                    }
+               }
+             else
+               {
+                  U na, nb;
+                  int l = ( n + 63 ) / 64;
+                  if( B <= 0 ) lin_comb( na, a, A, b, -(uint64_t)B, true, l );
+                  else lin_comb( na, b, B, a, -(uint64_t)A, true, l );
+                  if( D <= 0 ) lin_comb( nb, a, C, b, -(uint64_t)D, true, l );
+                  else lin_comb( nb, b, D, a, -(uint64_t)C, true, l );
+                  a = na;
+                  b = nb;
+                  if( s )
+                    {
+                       Cofactor< U > c = combine( as, A, bs, B );
+                       bs = combine( as, C, bs, D );
+                       as = c;
+                       c = combine( at, A, bt, B );
+                       bt = combine( at, C, bt, D );
+                       at = c;
+                    }
+               }
+          }
+        
+        if( s )
+          {
+             *s = as;
+             *t = at;
+          }
+        return a;
+     }
+}
+
+namespace multiint_detail
+{
+   /* x modulo m, between 0 and m-1, for a positive m. */
+   template< int W, typename u128, bool S > LargeInteger< W, u128, false > reduce( const LargeInteger< W, u128, S >& x, const LargeInteger< W, u128, false >& m )
+     {
+        LargeInteger< W, u128, false > r = magnitude_of( x ) % m;
+        return x.isNegative() && r.isPositive() ? m - r : r;
+     }
+   
+   /* a * b mod m for a and b already reduced. */
+   template< int W, typename u128 > LargeInteger< W, u128, false > mulmod_u( const LargeInteger< W, u128, false >& a, const LargeInteger< W, u128, false >& b,
+                                                                             const LargeInteger< W, u128, false >& m )
+     {
+        typedef LargeInteger< 2*W, u128, false > D;
+        D wa, wb, wm;
+        std::copy( a.limbs(), a.limbs() + a.L, wa.limbs() + a.L );
+        std::copy( b.limbs(), b.limbs() + b.L, wb.limbs() + b.L );
+        std::copy( m.limbs(), m.limbs() + m.L, wm.limbs() + m.L );
+        D r = ( wa * wb ) % wm;
+        LargeInteger< W, u128, false > res;
+        std::copy( r.limbs() + a.L, r.limbs() + 2 * a.L, res.limbs() );
+        return res;
+     }
+   
+   /* Inverse of a reduced value modulo m. */
+   template< int W, typename u128 > LargeInteger< W, u128, false > invmod_u( const LargeInteger< W, u128, false >& a, const LargeInteger< W, u128, false >& m )
+     {
+        typedef LargeInteger< W, u128, false > U;
+        Cofactor< U > cs, ct;
+        U g = lehmer_gcd( a, m, &cs, &ct );
+        if( g != U( 1 ) ) throw not_invertible_error( "Value is not invertible" );
+        if( m == U( 1 ) ) return U();
+        return cs.neg && cs.m.isPositive() ? m - cs.m : cs.m;
+     }
+   
+   /* Montgomery's trick on n values, see batchInvmod. */
+   template< int W, typename u128, bool S > void batch_invmod_u( const LargeInteger< W, u128, S >* x, LargeInteger< W, u128, false >* res, size_t n,
+                                                                const LargeInteger< W, u128, false >& m )
+     {
+        typedef LargeInteger< W, u128, false > U;
+        std::vector< U > v( n );
+        for( size_t i = 0; i < n; ++i ) v[ i ] = reduce( x[ i ], m );
+        res[ 0 ] = v[ 0 ];
+        for( size_t i = 1; i < n; ++i ) res[ i ] = mulmod_u( res[ i-1 ], v[ i ], m );
+        
+        U inv = invmod_u( res[ n-1 ], m );
+        for( size_t i = n-1; i > 0; --i )
+          {
+             res[ i ] = mulmod_u( inv, res[ i-1 ], m );
+             inv = mulmod_u( inv, v[ i ], m );
+          }
+        res[ 0 ] = inv;
+     }
+}
+
+namespace multiint_detail
+{
+   /* floor( sqrt( n ) ) by Newton's iteration. The first guess comes from
+    * the square root of the leading 64 bits and is slightly above the
+    * result, so the iterates decrease to it.
+    */
+   template< int W, typename u128 > LargeInteger< W, u128, false > isqrt_u( const LargeInteger< W, u128, false >& n )
+     {
+        typedef LargeInteger< W, u128, false > U;
+        int bits = n.bitLength();
+        if( bits <= 1 ) return n;
+        int shift = bits > 64 ? ( bits - 63 ) & ~1 : 0;
+        uint64_t top = n.extractBits( shift, 64 );
+        U x = U( (uint64_t)std::sqrt( (double)top ) + 2 ) << ( shift / 2 );
+        while( true )
+          {
+             U y = ( x + n / x ) >> 1;
+             if( y >= x ) return x;
+             x = y;
+          }
+     }
+   
+   template< class U > U ipow( U x, unsigned k )
+     {
+        U res( 1 );
+        for( ; k; k >>= 1, x *= x ) if( k & 1 ) res *= x;
+        return res;
+     }
+   
+   /* floor( n^(1/k) ) by Newton's iteration, the first guess being taken
+    * from the logarithm of the leading 64 bits, raised by a 2^-30 margin to
+    * be above the result.
+    */
+   template< int W, typename u128 > LargeInteger< W, u128, false > iroot_u( const LargeInteger< W, u128, false >& n, unsigned k )
+     {
+        typedef LargeInteger< W, u128, false > U;
+        int bits = n.bitLength();
+        if( k == 1 || bits <= 1 ) return n;
+        if( k >= (unsigned)bits ) return U( 1 );
+        if( k == 2 ) return isqrt_u( n );
+        
+        int shift = bits > 64 ? bits - 64 : 0;
+        double r = ( std::log2( (double)n.extractBits( shift, 64 ) ) + shift ) / k;
+        int e = (int)r;
+        U x;
+        if( e < 52 ) x = U( (uint64_t)std::exp2( r ) );
+        else x = U( (uint64_t)std::exp2( r - e + 52 ) ) << ( e - 52 );
+        x += ( x >> 30 ) + 1;
+        
+        while( true )
+          {
+             U y = ( x * ( k - 1 ) + n / ipow( x, k - 1 ) ) / (uint64_t)k;
+             if( y >= x ) return x;
+             x = y;
+          }
+     }
+   
+   /* Bit i of qr_mask( q ) is set when i is a square modulo q, q <= 64. */
+   constexpr uint64_t qr_mask( unsigned q, unsigned x = 0 )
+     {
+        return x == q ? 0 : ( 1ULL << ( x * x % q ) ) | qr_mask( q, x + 1 );
+     }
+}
+
+/* Integer square root: the largest s such that s * s <= n. Throws
+ * std::invalid_argument for a negative n.
+ */
+template< int W, typename u128, bool S > LargeInteger< W, u128, S > isqrt( const LargeInteger< W, u128, S >& n )
+{
+   if( n.isNegative() ) throw std::invalid_argument( "Square root of a negative value" );
+   return multiint_detail::with_sign< LargeInteger< W, u128, S > >( multiint_detail::isqrt_u( multiint_detail::magnitude_of( n ) ), false );
+}
+
+/* Integer square root s of n along with the remainder r = n - s * s. */
+template< int W, typename u128, bool S > LargeInteger< W, u128, S > isqrtRem( const LargeInteger< W, u128, S >& n, LargeInteger< W, u128, S >& r )
+{
+   LargeInteger< W, u128, S > s = isqrt( n );
+   r = n - s * s;
+   return s;
+}
+
+/* Integer k-th root, rounded toward zero. A negative n is only accepted
+ * for an odd k, otherwise std::invalid_argument is thrown as for k = 0.
+ */
+template< int W, typename u128, bool S > LargeInteger< W, u128, S > iroot( const LargeInteger< W, u128, S >& n, unsigned k )
+{
+   if( k == 0 ) throw std::invalid_argument( "Zeroth root" );
+   if( n.isNegative() && k % 2 == 0 ) throw std::invalid_argument( "Even root of a negative value" );
+   return multiint_detail::with_sign< LargeInteger< W, u128, S > >( multiint_detail::iroot_u( multiint_detail::magnitude_of( n ), k ), n.isNegative() );
+}
+
+/* Whether n is the square of an integer. Most non squares are rejected
+ * without computing the root, from their residues modulo 64, 63 and small
+ * primes, all taken from a single constant division.
+ */
+template< int W, typename u128, bool S > bool isPerfectSquare( const LargeInteger< W, u128, S >& n )
+{
+   static constexpr uint64_t qr64 = multiint_detail::qr_mask( 64 );
+   static constexpr uint64_t qr63 = multiint_detail::qr_mask( 63 );
+   static constexpr uint64_t qr5 = multiint_detail::qr_mask( 5 );
+   static constexpr uint64_t qr13 = multiint_detail::qr_mask( 13 );
+   static constexpr uint64_t qr11 = multiint_detail::qr_mask( 11 );
+   static constexpr uint64_t qr17 = multiint_detail::qr_mask( 17 );
+   static constexpr uint64_t qr19 = multiint_detail::qr_mask( 19 );
+   static constexpr uint64_t qr23 = multiint_detail::qr_mask( 23 );
+   static constexpr uint64_t qr29 = multiint_detail::qr_mask( 29 );
+   static constexpr uint64_t qr31 = multiint_detail::qr_mask( 31 );
+   
+   if( n.isNegative() ) return false;
+   if( !( ( qr64 >> ( n.limbs()[ n.L - 1 ] % 64 ) ) & 1 ) ) return false;
+   
+   const uint64_t M = 63ULL * 65 * 11 * 17 * 19 * 23 * 29 * 31;
+   uint64_t r = n.template modBy< M >();
+   if( !( ( qr63 >> ( r % 63 ) ) & 1 ) || !( ( qr5 >> ( r % 5 ) ) & 1 ) ||
+       !( ( qr13 >> ( r % 13 ) ) & 1 ) || !( ( qr11 >> ( r % 11 ) ) & 1 ) ||
+       !( ( qr17 >> ( r % 17 ) ) & 1 ) || !( ( qr19 >> ( r % 19 ) ) & 1 ) ||
+       !( ( qr23 >> ( r % 23 ) ) & 1 ) || !( ( qr29 >> ( r % 29 ) ) & 1 ) ||
+       !( ( qr31 >> ( r % 31 ) ) & 1 ) ) return false;
+   
+   LargeInteger< W, u128, S > r2;
+   isqrtRem( n, r2 );
+   return !r2.isPositive();
+}
+
+/* Greatest common divisor of the magnitudes of a and b, 0 when both are
+ * 0. Small widths use the binary algorithm, larger ones Lehmer's.
+ */
+template< int W, typename u128, bool S > LargeInteger< W, u128, S > gcd( const LargeInteger< W, u128, S >& a, const LargeInteger< W, u128, S >& b )
+{
+   LargeInteger< W, u128, false > g;
+   if( W <= 256 ) g = multiint_detail::binary_gcd( multiint_detail::magnitude_of( a ), multiint_detail::magnitude_of( b ) );
+   else g = multiint_detail::lehmer_gcd< W, u128 >( multiint_detail::magnitude_of( a ), multiint_detail::magnitude_of( b ), NULL, NULL );
+   return multiint_detail::with_sign< LargeInteger< W, u128, S > >( g, false );
+}
+
+/* Extended GCD: returns g = gcd( a, b ) and sets s and t such that
+ * a * s + b * t = g. For unsigned integers, s and t are given modulo 2^W.
+ */
+template< int W, typename u128, bool S > LargeInteger< W, u128, S > xgcd( const LargeInteger< W, u128, S >& a, const LargeInteger< W, u128, S >& b,
+                                                                           LargeInteger< W, u128, S >& s, LargeInteger< W, u128, S >& t )
+{
+   typedef LargeInteger< W, u128, false > U;
+   multiint_detail::Cofactor< U > cs, ct;
+   U g = multiint_detail::lehmer_gcd( multiint_detail::magnitude_of( a ), multiint_detail::magnitude_of( b ), &cs, &ct );
+   s = multiint_detail::with_sign< LargeInteger< W, u128, S > >( cs.m, cs.neg != a.isNegative() );
+   t = multiint_detail::with_sign< LargeInteger< W, u128, S > >( ct.m, ct.neg != b.isNegative() );
+   return multiint_detail::with_sign< LargeInteger< W, u128, S > >( g, false );
+}
+
+/* a * b modulo m, between 0 and m-1. The product is computed exactly in
+ * an integer of twice the width before the reduction.
+ */
+template< int W, typename u128, bool S > LargeInteger< W, u128, S > mulmod( const LargeInteger< W, u128, S >& a, const LargeInteger< W, u128, S >& b, const LargeInteger< W, u128, S >& m )
+{
+   if( m.isNegative() || !m.isPositive() ) throw std::invalid_argument( "Modulus must be positive" );
+   LargeInteger< W, u128, false > um = multiint_detail::magnitude_of( m );
+   return multiint_detail::with_sign< LargeInteger< W, u128, S > >( multiint_detail::mulmod_u( multiint_detail::reduce( a, um ), multiint_detail::reduce( b, um ), um ), false );
+}
+
+/* Inverse of a modulo m, between 0 and m-1. Throws not_invertible_error
+ * when a and m are not coprime.
+ */
+template< int W, typename u128, bool S > LargeInteger< W, u128, S > invmod( const LargeInteger< W, u128, S >& a, const LargeInteger< W, u128, S >& m )
+{
+   typedef LargeInteger< W, u128, false > U;
+   if( m.isNegative() || !m.isPositive() ) throw std::invalid_argument( "Modulus must be positive" );
+   U um = multiint_detail::magnitude_of( m );
+   return multiint_detail::with_sign< LargeInteger< W, u128, S > >( multiint_detail::invmod_u( multiint_detail::reduce( a, um ), um ), false );
+}
+
+/* Replaces each of the n values starting at x by its inverse modulo m,
+ * with Montgomery's trick: the running products of the values are
+ * inverted once and the individual inverses are peeled off, for a total of
+ * one inversion and 3(n-1) modular multiplications. With threads > 1 the
+ * values are split in as many consecutive chunks, each processed the same
+ * way on the threads of fork_join. Throws not_invertible_error, leaving the values
+ * untouched, when one of them is not coprime with m.
+ */
+template< int W, typename u128, bool S > void batchInvmod( LargeInteger< W, u128, S >* x, size_t n, const LargeInteger< W, u128, S >& m, int threads = 1 )
+{
+   typedef LargeInteger< W, u128, false > U;
+   if( m.isNegative() || !m.isPositive() ) throw std::invalid_argument( "Modulus must be positive" );
+   if( n == 0 ) return;
+   U um = multiint_detail::magnitude_of( m );
+   std::vector< U > res( n );
+   
+   size_t chunks = threads > 1 ? std::min( (size_t)threads, n ) : 1;
+   multiint_detail::fork_join( (int)chunks, [ & ]( int c )
+     {
+        size_t begin = n * c / chunks;
+        size_t end = n * ( c + 1 ) / chunks;
+        multiint_detail::batch_invmod_u( x + begin, &res[ begin ], end - begin, um );
+     } );
+   
+   for( size_t i = 0; i < n; ++i ) x[ i ] = multiint_detail::with_sign< LargeInteger< W, u128, S > >( res[ i ], false );
+}
+
+namespace multiint_detail
+{
+   /* Arithmetic modulo an odd m in Montgomery form, where x is represented
+    * by x * 2^W mod m. Products then only need a Montgomery reduction
+    * instead of a division.
+    */
+   template< int W, typename u128 > class Montgomery
+   {
+    public:
+      typedef LargeInteger< W, u128, false > U;
+      static const int L = U::L;
+      
+      explicit Montgomery( const U& m ) : m( m ), minv( neg_inverse_1( m.limbs()[ L-1 ] ) )
+        {
+           r1 = ( U() - m ) % m;
+           r2 = r1;
+           for( int i = 0; i < W; ++i ) r2 = add( r2, r2 );
+        }
+      
+      const U& modulus() const
+        {
+           return m;
+        }
+      
+      /* 1 in Montgomery form. */
+      const U& one() const
+        {
+           return r1;
+        }
+      
+      U toMont( const U& a ) const
+        {
+           return mul( a, r2 );
+        }
+      
+      U fromMont( const U& a ) const
+        {
+           return mul( a, U( 1 ) );
+        }
+      
+      U mul( const U& a, const U& b ) const
+        {
+           uint64_t t[ 2*L ];
+           mul_n( t, a.limbs(), L, b.limbs(), L );
+           U res;
+           redc_n( res.limbs(), t, m.limbs(), minv, L );
+           return res;
+        }
+      
+      U add( const U& a, const U& b ) const
+        {
+           U res = a + b;
+           if( res < a ) res -= m;
+           else csub_n( res.limbs(), m.limbs(), L );
+           return res;
+        }
+      
+      U sub( const U& a, const U& b ) const
+        {
+           U res = a - b;
+           if( a < b ) res += m;
+           return res;
+        }
+      
+      /* a / 2, m being odd. */
+      U half( const U& a ) const
+        {
+           if( a.testBit( 0 ) ) return ( a >> 1 ) + ( m >> 1 ) + 1;
+           return a >> 1;
+        }
+      
+      /* a^e with a in Montgomery form, using windows of 4 bits of e. */
+      U pow( const U& a, const U& e ) const
+        {
+           U table[ 16 ];
+           table[ 0 ] = r1;
+           for( int i = 1; i < 16; ++i ) table[ i ] = mul( table[ i-1 ], a );
+           
+           int bits = e.bitLength();
+           int pos = ( bits + 3 ) / 4 * 4;
+           U res = r1;
+           while( pos > 0 )
+             {
+                pos -= 4;
+                if( res != r1 ) for( int i = 0; i < 4; ++i ) res = mul( res, res );
+                uint64_t w = e.extractBits( pos, 4 );
+                if( w ) res = mul( res, table[ w ] );
+             }
+           return res;
+        }
+      
+    private:
+      U m;
+      uint64_t minv;
+      U r1;
+      U r2;
+   };
+   
+   /* Odd primes below 2^12 used for trial division, gathered in groups whose
+    * product fits in a limb: a single division pass over the limbs gives
+    * the remainder modulo all the primes of a group.
+    */
+   struct SmallPrimes
+   {
+      struct Group
+      {
+         Divisor64 product;
+         int first;
+         int count;
+      };
+      
+      enum { bound = 1 << 12 };
+      std::vector< uint32_t > primes;
+      std::vector< Group > groups;
+      
+      SmallPrimes()
+        {
+           std::vector< bool > composite( bound );
+           for( uint32_t i = 3; i < (uint32_t)bound; i += 2 )
+             {
+                if( composite[ i ] ) continue;
+                primes.push_back( i );
+                for( uint32_t j = i * i; j < (uint32_t)bound; j += 2 * i ) composite[ j ] = true;
+             }
+           
+           for( size_t i = 0; i < primes.size(); )
+             {
+                uint64_t prod = 1;
+                size_t j = i;
+                while( j < primes.size() && prod <= ~0ULL / primes[ j ] ) prod *= primes[ j++ ];
+                Group g = { Divisor64( prod ), (int)i, (int)( j - i ) };
+                groups.push_back( g );
+                i = j;
+             }
+        }
+      
+      static const SmallPrimes& get()
+        {
+           static const SmallPrimes table;
+           return table;
+        }
+   };
+   
+   /* Smallest odd prime below 2^12 dividing n, 0 if there is none. */
+   template< int W, typename u128 > uint32_t small_factor( const LargeInteger< W, u128, false >& n )
+     {
+        const SmallPrimes& sp = SmallPrimes::get();
+        int l = ( n.bitLength() + 63 ) / 64;
+        for( size_t g = 0; g < sp.groups.size(); ++g )
+          {
+             uint64_t r = sp.groups[ g ].product.divrem( NULL, n.limbs() + n.L - l, l );
+             for( int i = 0; i < sp.groups[ g ].count; ++i )
+               {
+                  uint32_t p = sp.primes[ sp.groups[ g ].first + i ];
+                  if( r % p == 0 ) return p;
+               }
+          }
+        return 0;
+     }
+   
+   /* Jacobi symbol ( a / n ) for an odd n. */
+   inline int jacobi_1( uint64_t a, uint64_t n )
+     {
+        int res = 1;
+        a %= n;
+        while( a )
+          {
+             while( a % 2 == 0 )
+               {
+                  a /= 2;
+                  if( n % 8 == 3 || n % 8 == 5 ) res = -res;
+               }
+             std::swap( a, n );
+             if( a % 4 == 3 && n % 4 == 3 ) res = -res;
+             a %= n;
+          }
+        return n == 1 ? res : 0;
+     }
+   
+   /* Jacobi symbol ( d / n ) for a small odd d and an odd n, by quadratic
+    * reciprocity so only n mod |d| is needed.
+    */
+   template< int W, typename u128 > int jacobi_small( int64_t d, const LargeInteger< W, u128, false >& n )
+     {
+        uint64_t a = d < 0 ? -(uint64_t)d : d;
+        uint64_t n4 = n.limbs()[ n.L-1 ] % 4;
+        int res = d < 0 && n4 == 3 ? -1 : 1;
+        if( a % 4 == 3 && n4 == 3 ) res = -res;
+        return res * jacobi_1( n % a, a );
+     }
+   
+   /* Strong probable prime test to base a, given in Montgomery form. */
+   template< int W, typename u128 > bool miller_rabin( const Montgomery< W, u128 >& ctx, const LargeInteger< W, u128, false >& a )
+     {
+        typedef LargeInteger< W, u128, false > U;
+        U nm1 = ctx.modulus() - 1;
+        int s = nm1.countTrailingZeros();
+        U minus1 = ctx.modulus() - ctx.one();
+        U x = ctx.pow( a, nm1 >> s );
+        if( x == ctx.one() || x == minus1 ) return true;
+        for( int i = 1; i < s; ++i )
+          {
+             x = ctx.mul( x, x );
+             if( x == minus1 ) return true;
+             if( x == ctx.one() ) return false;
+          }
+        return false;
+     }
+   
+   /* Strong Lucas probable prime test with Selfridge's parameters: D is the
+    * first of 5, -7, 9, -11, ... with ( D / n ) = -1, P = 1 and
+    * Q = ( 1 - D ) / 4. n must be odd, not a square and have no small factor.
+    */
+   template< int W, typename u128 > bool strong_lucas( const Montgomery< W, u128 >& ctx )
+     {
+        typedef LargeInteger< W, u128, false > U;
+        const U& n = ctx.modulus();
+        int64_t d = 5;
+        while( true )
+          {
+             int j = jacobi_small( d, n );
+             if( j == -1 ) break;
+             if( j == 0 ) return false;
+             d = d > 0 ? -( d + 2 ) : 2 - d;
+          }
+        int64_t q = ( 1 - d ) / 4;
+        U dm = ctx.toMont( d < 0 ? n - U( (uint64_t)-d ) : U( (uint64_t)d ) );
+        U qm = ctx.toMont( q < 0 ? n - U( (uint64_t)-q ) : U( (uint64_t)q ) );
+        
+        U k = n + 1;
+        int s = k.countTrailingZeros();
+        k >>= s;
+        
+        /* Binary ladder on the bits of k for U_k, V_k and Q^k. */
+        U u = ctx.one();
+        U v = ctx.one();
+        U qk = qm;
+        for( int i = k.bitLength() - 2; i >= 0; --i )
+          {
+             u = ctx.mul( u, v );
+             v = ctx.sub( ctx.mul( v, v ), ctx.add( qk, qk ) );
+             qk = ctx.mul( qk, qk );
+             if( k.testBit( i ) )
+               {
+                  U nu = ctx.half( ctx.add( u, v ) );
+                  v = ctx.half( ctx.add( ctx.mul( dm, u ), v ) );
+                  u = nu;
+                  qk = ctx.mul( qk, qm );
+               }
+          }
+        
+        if( !u.isPositive() || !v.isPositive() ) return true;
+        for( int r = 1; r < s; ++r )
+          {
+             v = ctx.sub( ctx.mul( v, v ), ctx.add( qk, qk ) );
+             if( !v.isPositive() ) return true;
+             qk = ctx.mul( qk, qk );
+          }
+        return false;
+     }
+   
+   inline uint64_t splitmix64( uint64_t& state )
+     {
+        uint64_t z = ( state += 0x9E3779B97F4A7C15ULL );
+        z = ( z ^ ( z >> 30 ) ) * 0xBF58476D1CE4E5B9ULL;
+        z = ( z ^ ( z >> 27 ) ) * 0x94D049BB133111EBULL;
+        return z ^ ( z >> 31 );
+     }
+   
+   /* Baillie-PSW test followed by rounds Miller-Rabin tests to bases drawn
+    * from a generator seeded by n, so the answer for a given n never
+    * changes. The trial division can be skipped when already done by a
+    * sieve.
+    */
+   template< int W, typename u128 > bool probable_prime_u( const LargeInteger< W, u128, false >& n, int rounds, bool trial )
+     {
+        typedef LargeInteger< W, u128, false > U;
+        if( n < U( 2 ) ) return false;
+        if( !n.testBit( 0 ) ) return n == U( 2 );
+        if( trial )
+          {
+             uint32_t p = small_factor( n );
+             if( p ) return n == U( p );
+          }
+        if( n.bitLength() <= 24 ) return true;
+        
+        Montgomery< W, u128 > ctx( n );
+        if( !miller_rabin( ctx, ctx.toMont( U( 2 ) ) ) ) return false;
+        if( isPerfectSquare( n ) || !strong_lucas( ctx ) ) return false;
+        
+        uint64_t state = n.limbs()[ n.L-1 ];
+        U range = n - 3;
+        for( int i = 0; i < rounds; ++i )
+          {
+             U a;
+             for( int k = 0; k < n.L; ++k ) a.limbs()[ k ] = splitmix64( state );
+             a = a % range + 2;
+             if( !miller_rabin( ctx, ctx.toMont( a ) ) ) return false;
+          }
+        return true;
+     }
+}
+
+/* base^e modulo m, between 0 and m-1. Odd moduli use Montgomery
+ * multiplication. A negative exponent uses the inverse of base and throws
+ * not_invertible_error when there is none.
+ */
+template< int W, typename u128, bool S > LargeInteger< W, u128, S > powmod( const LargeInteger< W, u128, S >& base, const LargeInteger< W, u128, S >& e, const LargeInteger< W, u128, S >& m )
+{
+   typedef LargeInteger< W, u128, false > U;
+   if( m.isNegative() || !m.isPositive() ) throw std::invalid_argument( "Modulus must be positive" );
+   U um = multiint_detail::magnitude_of( m );
+   U b = multiint_detail::reduce( base, um );
+   if( e.isNegative() ) b = multiint_detail::invmod_u( b, um );
+   U ue = multiint_detail::magnitude_of( e );
+   if( um == U( 1 ) ) return LargeInteger< W, u128, S >();
+   
+   U res;
+   if( um.testBit( 0 ) )
+     {
+        multiint_detail::Montgomery< W, u128 > ctx( um );
+        res = ctx.fromMont( ctx.pow( ctx.toMont( b ), ue ) );
+     }
+   else
+     {
+        res = U( 1 );
+        for( int i = ue.bitLength() - 1; i >= 0; --i )
+          {
+             res = multiint_detail::mulmod_u( res, res, um );
+             if( ue.testBit( i ) ) res = multiint_detail::mulmod_u( res, b, um );
+          }
+     }
+   return multiint_detail::with_sign< LargeInteger< W, u128, S > >( res, false );
+}
+
+/* Probable primality test: trial division by the primes below 2^12, then
+ * the Baillie-PSW test (Miller-Rabin to base 2 and strong Lucas test), for
+ * which no composite is known to pass, then rounds more Miller-Rabin tests
+ * to pseudo random bases. Exact below 2^64.
+ */
+template< int W, typename u128, bool S > bool isProbablePrime( const LargeInteger< W, u128, S >& n, int rounds = 0 )
+{
+   if( n.isNegative() ) return false;
+   return multiint_detail::probable_prime_u( multiint_detail::magnitude_of( n ), rounds, true );
+}
+
+/* Smallest probable prime greater than n, see isProbablePrime. Candidates
+ * are sieved by windows with the small primes, starting from the
+ * remainders of the first candidate. With threads > 1, the candidates that
+ * survive the sieve are shared between as many threads, which stop past
+ * the smallest prime found so the result does not depend on the number of
+ * threads. Throws std::overflow_error when there is no prime left below
+ * the largest value of the type.
+ */
+template< int W, typename u128, bool S > LargeInteger< W, u128, S > nextPrime( const LargeInteger< W, u128, S >& n, int rounds = 0, int threads = 1 )
+{
+   typedef LargeInteger< W, u128, false > U;
+   const multiint_detail::SmallPrimes& sp = multiint_detail::SmallPrimes::get();
+   if( n < LargeInteger< W, u128, S >( 2 ) ) return LargeInteger< W, u128, S >( 2 );
+   
+   U limit = ~U();
+   if( S ) limit >>= 1;
+   U c = multiint_detail::magnitude_of( n ) + 1;
+   if( !c.isPositive() ) throw std::overflow_error( "No prime below the limit" );
+   if( !c.testBit( 0 ) ) c += 1;
+   
+   const int window = 4096;
+   std::vector< bool > composite( window );
+   std::vector< U > candidates;
+   while( true )
+     {
+        /* Marks the odd values c + 2i divisible by a small prime. */
+        std::fill( composite.begin(), composite.end(), false );
+        int l = ( c.bitLength() + 63 ) / 64;
+        for( size_t g = 0; g < sp.groups.size(); ++g )
+          {
+             uint64_t r = sp.groups[ g ].product.divrem( NULL, c.limbs() + c.L - l, l );
+             for( int k = 0; k < sp.groups[ g ].count; ++k )
+               {
+                  uint32_t p = sp.primes[ sp.groups[ g ].first + k ];
+                  uint64_t i = ( p - r % p ) % p * ( ( p + 1 ) / 2 ) % p;
+                  if( c.bitLength() <= 12 && c + 2 * i == U( p ) ) i += p;
+                  for( ; i < (uint64_t)window; i += p ) composite[ i ] = true;
+               }
+          }
+        
+        candidates.clear();
+        for( int i = 0; i < window; ++i )
+          {
+             if( composite[ i ] ) continue;
+             U x = c + 2 * (uint64_t)i;
+             if( x < c || x > limit ) break;
+             candidates.push_back( x );
+          }
+        
+        /* Thread t tests the candidates t, t + step, t + 2 step... in
+         * increasing order, until it finds a prime or reaches the smallest
+         * one found so far.
+         */
+        size_t step = threads > 1 ? std::min( (size_t)threads, candidates.size() ) : 1;
+        std::atomic< size_t > found( candidates.size() );
+        multiint_detail::fork_join( (int)step, [ & ]( int t )
+          {
+             for( size_t k = t; k < found.load(); k += step )
+               if( multiint_detail::probable_prime_u( candidates[ k ], rounds, false ) )
+                 {
+                    size_t f = found.load();
+                    while( k < f && !found.compare_exchange_weak( f, k ) );
+                    return;
+                 }
+          } );
+        if( found < candidates.size() ) return multiint_detail::with_sign< LargeInteger< W, u128, S > >( candidates[ found ], false );
+        
+        U next = c + 2 * (uint64_t)window;
+        if( next < c || next > limit ) throw std::overflow_error( "No prime below the limit" );
+        c = next;
+     }
+}
+
+/* Reduction modulo p = 2^K - C for a small C, such as 2^255 - 19 or the
+ * Mersenne number 2^521 - 1, on unsigned integers of W bits. As 2^K = C
+ * modulo p, the bits of a value above K are folded back by adding them
+ * multiplied by C to the low K bits, which quickly leaves a value below
+ * 2^K, and then below p with a single conditional subtraction, which is
+ * enough as long as C is below 2^(K-1). The split position is a constant
+ * so the shifts and masks are resolved at compile time.
+ */
+template< int W, int K, uint64_t C, typename u128 = uint128_t > class SpecialModulus
+{
+ public:
+   typedef LargeInteger< W, u128, false > Integer;
+   typedef LargeInteger< 2*W, u128, false > WideInteger;
+   
+   static_assert( K > 1 && K <= W, "The modulus must fit in the integer" );
+   static_assert( C > 0 && ( K > 64 || C < ( 1ULL << ( K <= 64 ? K - 1 : 0 ) ) ), "C must be below 2^(K-1)" );
+   
+   static MULTIINT_CONSTEXPR Integer modulus()
+     {
+        return ( Integer( 1 ) << K ) - C;
+     }
+   
+   static MULTIINT_CONSTEXPR Integer reduce( const WideInteger& x )
+     {
+        return fold( x );
+     }
+   
+   static MULTIINT_CONSTEXPR Integer reduce( const Integer& x )
+     {
+        return fold( x );
+     }
+   
+   /* a * b mod p for reduced a and b. */
+   static MULTIINT_CONSTEXPR Integer mul( const Integer& a, const Integer& b )
+     {
+        return fold( mulWide( a, b ) );
+     }
+   
+   static MULTIINT_CONSTEXPR Integer add( const Integer& a, const Integer& b )
+     {
+        Integer res = a + b;
+        if( res < a || res >= modulus() ) res -= modulus();
+        return res;
+     }
+   
+   static MULTIINT_CONSTEXPR Integer sub( const Integer& a, const Integer& b )
+     {
+        Integer res = a - b;
+        if( a < b ) res += modulus();
+        return res;
+     }
+   
+ private:
+   /* x >> K, which is 0 when K is the width of x. */
+   template< class T > static MULTIINT_CONSTEXPR T high( const T& x )
+     {
+        return K < 64 * T::L ? x.template shr< ( K < 64 * T::L ? K : 0 ) >() : T();
+     }
+   
+   template< class T > static MULTIINT_CONSTEXPR Integer fold( T x )
+     {
+        T hi = high( x );
+        while( hi.isPositive() )
+          {
+             uint64_t* l = x.limbs();
+             for( int k = 0; k < T::L - 1 - ( K-1 ) / 64; ++k ) l[ k ] = 0;
+             if( K % 64 ) l[ T::L - 1 - ( K-1 ) / 64 ] &= ~0ULL >> ( 64 - K % 64 );
+             x += hi * C;
+             hi = high( x );
+          }
+        
+        Integer res;
+        for( int k = 0; k < Integer::L; ++k ) res.limbs()[ k ] = x.limbs()[ T::L - Integer::L + k ];
+        if( res >= modulus() ) res -= modulus();
+        return res;
+     }
+};
+
+namespace multiint_detail
+{
+   /* Basis of the residue number system used by RnsInteger< W >: primes
+    * between 2^61 and 2^62, enough of them for their product M to exceed
+    * 2^(2W+2), with the constants of the Montgomery arithmetic modulo each
+    * of them and of Garner's reconstruction. Built once, on first use.
+    */
+   template< int W > class RnsBasis
+   {
+    public:
+      enum { size = ( 2*W + 2 + 60 ) / 61, limbs = ( 62 * size + 63 ) / 64 };
+      
+      uint64_t p[ size ];
+      uint64_t minv[ size ];
+      /* 2^128 mod p, to move into Montgomery form. */
+      uint64_t r2[ size ];
+      /* 1 / ( p[0] * ... * p[i-1] ) mod p[i], in Montgomery form. */
+      uint64_t garner[ size ];
+      /* M and ( M - 1 ) / 2, most significant limb first. */
+      uint64_t product[ limbs ];
+      uint64_t half[ limbs ];
+      
+      static const RnsBasis& get()
+        {
+           static const RnsBasis basis;
+           return basis;
+        }
+      
+    private:
+      RnsBasis()
+        {
+           UnsignedLargeInteger< 64 > c( (uint64_t)( ( 1ULL << 62 ) - 1 ) );
+           for( int i = 0; i < size; ++i )
+             {
+                while( !probable_prime_u( c, 0, true ) ) c -= 2;
+                p[ i ] = c.limbs()[ 0 ];
+                c -= 2;
+                minv[ i ] = neg_inverse_1( p[ i ] );
+                uint64_t r = -p[ i ] % p[ i ];
+                for( int k = 0; k < 64; ++k ) r = addmod_1( r, r, p[ i ] );
+                r2[ i ] = r;
+             }
+           
+           for( int i = 0; i < size; ++i )
+             {
+                uint64_t one = mont_mul_1( 1, r2[ i ], p[ i ], minv[ i ] );
+                uint64_t prefix = one;
+                for( int j = 0; j < i; ++j ) prefix = mont_mul_1( prefix, toMont( i, p[ j ] ), p[ i ], minv[ i ] );
+                
+                /* Fermat's inverse, p[i] being prime. */
+                uint64_t inv = one, e = p[ i ] - 2;
+                for( int k = 63; k >= 0; --k )
+                  {
+                     inv = mont_mul_1( inv, inv, p[ i ], minv[ i ] );
+                     if( e >> k & 1 ) inv = mont_mul_1( inv, prefix, p[ i ], minv[ i ] );
+                  }
+                garner[ i ] = inv;
+             }
+           
+           for( int k = 0; k < limbs; ++k ) product[ k ] = 0;
+           product[ limbs-1 ] = 1;
+           for( int i = 0; i < size; ++i ) muladd_1( product, product, p[ i ], 0, limbs );
+           rshift_fill( half, product, 1, 0, limbs );
+        }
+      
+    public:
+      /* Montgomery form modulo p[i] of any 64-bit x. */
+      uint64_t toMont( int i, uint64_t x ) const
+        {
+           return mont_mul_1( x, r2[ i ], p[ i ], minv[ i ] );
+        }
+   };
+}
+
+/* An integer of up to about 2W bits stored as its residues modulo the
+ * primes of RnsBasis< W >, in Montgomery form. Additions and
+ * multiplications work on each residue independently, without any carry,
+ * so a product of two W-bit values costs a multiplication per residue once
+ * they have been converted. Values are exact while their magnitude stays
+ * below M / 2, which includes any product of two LargeInteger< W > and sums
+ * of a few of them. Converting back rebuilds the value by Garner's
+ * algorithm; toInteger() then wraps it to W bits the way LargeInteger
+ * arithmetic does, toWide() keeps 2W bits.
+ *
+ * Conversions cost O(size * L) and O(size^2) multiplications of residues,
+ * the batched versions share the basis constants between the values.
+ */
+template< int W > class RnsInteger
+{
+ public:
+   typedef multiint_detail::RnsBasis< W > Basis;
+   enum { size = Basis::size };
+   
+   RnsInteger() : r()
+     {
+     }
+   
+   RnsInteger( int64_t i ) : r()
+     {
+        LargeInteger< W > x( i );
+        fromIntegers( &x, this, 1 );
+     }
+   
+   template< typename u128, bool S > explicit RnsInteger( const LargeInteger< W, u128, S >& x ) : r()
+     {
+        fromIntegers( &x, this, 1 );
+     }
+   
+   template< typename u128 = uint128_t, bool S = true > LargeInteger< W, u128, S > toInteger() const
+     {
+        LargeInteger< W, u128, S > res;
+        toIntegers( this, &res, 1 );
+        return res;
+     }
+   
+   LargeInteger< 2*W > toWide() const
+     {
+        LargeInteger< 2*W > res;
+        reconstruct( this, &res, 1 );
+        return res;
+     }
+   
+   /* Residue i, between 0 and Basis::get().p[ i ]. */
+   uint64_t residue( int i ) const
+     {
+        const Basis& b = Basis::get();
+        return multiint_detail::mont_mul_1( r[ i ], 1, b.p[ i ], b.minv[ i ] );
+     }
+   
+   RnsInteger operator+( const RnsInteger& y ) const
+     {
+        RnsInteger res( *this );
+        return res += y;
+     }
+   
+   RnsInteger operator-( const RnsInteger& y ) const
+     {
+        RnsInteger res( *this );
+        return res -= y;
+     }
+   
+   RnsInteger operator*( const RnsInteger& y ) const
+     {
+        RnsInteger res( *this );
+        return res *= y;
+     }
+   
+   RnsInteger operator-() const
+     {
+        return RnsInteger() - *this;
+     }
+   
+   RnsInteger& operator+=( const RnsInteger& y )
+     {
+        const Basis& b = Basis::get();
+        for( int i = 0; i < size; ++i ) r[ i ] = multiint_detail::addmod_1( r[ i ], y.r[ i ], b.p[ i ] );
+        return *this;
+     }
+   
+   RnsInteger& operator-=( const RnsInteger& y )
+     {
+        const Basis& b = Basis::get();
+        for( int i = 0; i < size; ++i ) r[ i ] = multiint_detail::submod_1( r[ i ], y.r[ i ], b.p[ i ] );
+        return *this;
+     }
+   
+   RnsInteger& operator*=( const RnsInteger& y )
+     {
+        const Basis& b = Basis::get();
+        for( int i = 0; i < size; ++i ) r[ i ] = multiint_detail::mont_mul_1( r[ i ], y.r[ i ], b.p[ i ], b.minv[ i ] );
+        return *this;
+     }
+   
+   bool operator==( const RnsInteger& y ) const
+     {
+        for( int i = 0; i < size; ++i ) if( r[ i ] != y.r[ i ] ) return false;
+        return true;
+     }
+   
+   bool operator!=( const RnsInteger& y ) const
+     {
+        return !( *this == y );
+     }
+   
+   /* Converts the n values of x into res. */
+   template< typename u128, bool S > static void fromIntegers( const LargeInteger< W, u128, S >* x, RnsInteger* res, size_t n )
+     {
+        const Basis& b = Basis::get();
+        const int L = LargeInteger< W, u128, S >::L;
+        std::vector< LargeInteger< W, u128, false > > mag( n );
+        for( size_t v = 0; v < n; ++v ) mag[ v ] = multiint_detail::magnitude_of( x[ v ] );
+        
+        for( int i = 0; i < size; ++i )
+          {
+             uint64_t p = b.p[ i ], minv = b.minv[ i ], r2 = b.r2[ i ];
+             for( size_t v = 0; v < n; ++v )
+               {
+                  const uint64_t* a = mag[ v ].limbs();
+                  uint64_t acc = 0;
+                  for( int k = 0; k < L; ++k )
+                    {
+                       acc = multiint_detail::mont_mul_1( acc, r2, p, minv );
+                       acc = multiint_detail::addmod_1( acc, multiint_detail::mont_mul_1( a[ k ], r2, p, minv ), p );
+                    }
+                  res[ v ].r[ i ] = x[ v ].isNegative() ? multiint_detail::submod_1( 0, acc, p ) : acc;
+               }
+          }
+     }
+   
+   /* Converts the n values of x into res, wrapped to W bits. */
+   template< typename u128, bool S > static void toIntegers( const RnsInteger* x, LargeInteger< W, u128, S >* res, size_t n )
+     {
+        reconstruct( x, res, n );
+     }
+   
+ private:
+   uint64_t r[ size ];
+   
+   /* Garner's algorithm: the mixed radix digits d[i] of the value, with
+    * x = d[0] + d[1] p[0] + d[2] p[0] p[1] + ..., are found one prime at a
+    * time. The value is then evaluated by Horner's rule, the representative
+    * between -M/2 and M/2 taken and its low limbs stored in res.
+    */
+   template< class I > static void reconstruct( const RnsInteger* x, I* res, size_t n )
+     {
+        const Basis& b = Basis::get();
+        std::vector< uint64_t > d( n * size ), s( n );
+        for( int i = 0; i < size; ++i )
+          {
+             uint64_t p = b.p[ i ], minv = b.minv[ i ];
+             for( size_t v = 0; v < n; ++v )
+               {
+                  uint64_t di = i ? d[ v * size + i-1 ] : 0;
+                  s[ v ] = di >= p ? di - p : di;
+               }
+             for( int j = i-2; j >= 0; --j )
+               {
+                  uint64_t pj = b.toMont( i, b.p[ j ] );
+                  for( size_t v = 0; v < n; ++v )
+                    {
+                       uint64_t dj = d[ v * size + j ];
+                       s[ v ] = multiint_detail::addmod_1( multiint_detail::mont_mul_1( s[ v ], pj, p, minv ), dj >= p ? dj - p : dj, p );
+                    }
+               }
+             for( size_t v = 0; v < n; ++v )
+               {
+                  uint64_t xi = multiint_detail::mont_mul_1( x[ v ].r[ i ], 1, p, minv );
+                  d[ v * size + i ] = multiint_detail::mont_mul_1( multiint_detail::submod_1( xi, s[ v ], p ), b.garner[ i ], p, minv );
+               }
+          }
+        
+        uint64_t t[ Basis::limbs ];
+        for( size_t v = 0; v < n; ++v )
+          {
+             for( int k = 0; k < Basis::limbs; ++k ) t[ k ] = 0;
+             for( int i = size-1; i >= 0; --i ) multiint_detail::muladd_1( t, t, i + 1 < size ? b.p[ i ] : 0, d[ v * size + i ], Basis::limbs );
+             bool above = false;
+             for( int k = 0; k < Basis::limbs; ++k )
+               if( t[ k ] != b.half[ k ] )
+                 {
+                    above = t[ k ] > b.half[ k ];
+                    break;
+                 }
+             if( above ) multiint_detail::sub_n( t, t, b.product, Basis::limbs );
+             
+             uint64_t fill = above ? ~0ULL : 0;
+             uint64_t* out = res[ v ].limbs();
+             for( int k = 0; k < I::L; ++k ) out[ I::L-1 - k ] = k < Basis::limbs ? t[ Basis::limbs-1 - k ] : fill;
+          }
+     }
+};
 
-template< int W, typename u128, typename l > LargeInteger< W, u128 > operator+( l i, const LargeInteger< W, u128 >& j )
+namespace multiint_detail
 {
-   return j + i;
+   /* Limb buffers of DynamicLargeInteger that do not fit in its inline
+    * limbs, through LimbAllocator. Sizes are rounded up to a power of two
+    * and released buffers are kept per size class, up to cached of them and
+    * MULTIINT_LIMB_POOL_LIMBS limbs in all, for the next allocations of the
+    * same thread, so that temporaries of similar sizes do not go through the
+    * heap. Buffers beyond the largest size class always go to the heap.
+    * Each thread has its own pool, freed when the thread exits.
+    */
+   class LimbPool
+   {
+    public:
+      enum { classes = 31, cached = 16 };
+      
+      /* A buffer of n limbs rounded up to a power of two. */
+      static uint64_t* allocate( size_t n )
+        {
+           int c = sizeClass( n );
+           LimbPool* pool = c < classes ? get() : NULL;
+           if( pool && pool->count[ c ] )
+             {
+                pool->limbs -= (size_t)1 << c;
+                return pool->buffers[ c ][ --pool->count[ c ] ];
+             }
+           return new uint64_t[ (size_t)1 << c ];
+        }
+      
+      /* Gives back a buffer from allocate( n ). */
+      static void release( uint64_t* p, size_t n )
+        {
+           int c = sizeClass( n );
+           LimbPool* pool = c < classes ? get() : NULL;
+           if( pool && pool->count[ c ] < cached && pool->limbs + ( (size_t)1 << c ) <= MULTIINT_LIMB_POOL_LIMBS )
+             {
+                pool->limbs += (size_t)1 << c;
+                pool->buffers[ c ][ pool->count[ c ]++ ] = p;
+             }
+           else delete[] p;
+        }
+      
+      ~LimbPool()
+        {
+           destroyed() = true;
+           for( int c = 0; c < classes; ++c )
+             for( int i = 0; i < count[ c ]; ++i ) delete[] buffers[ c ][ i ];
+        }
+      
+    private:
+      LimbPool() : count(), limbs( 0 )
+        {
+        }
+      
+      /* The pool of the calling thread, NULL once it has been destroyed at
+       * thread exit, for the values that outlive it.
+       */
+      static LimbPool* get()
+        {
+           if( destroyed() ) return NULL;
+           static thread_local LimbPool pool;
+           return &pool;
+        }
+      
+      static bool& destroyed()
+        {
+           static thread_local bool flag = false;
+           return flag;
+        }
+      
+      static int sizeClass( size_t n )
+        {
+           int c = 0;
+           while( ( (size_t)1 << c ) < n ) ++c;
+           return c;
+        }
+      
+      uint64_t* buffers[ classes ][ cached ];
+      int count[ classes ];
+      /* Total size of the cached buffers. */
+      size_t limbs;
+   };
+   
+   /* The default allocator of DynamicLargeInteger, a stateless one over the
+    * LimbPool of the calling thread.
+    */
+   class LimbAllocator
+   {
+    public:
+      typedef uint64_t value_type;
+      
+      uint64_t* allocate( size_t n )
+        {
+           return LimbPool::allocate( n );
+        }
+      
+      void deallocate( uint64_t* p, size_t n )
+        {
+           LimbPool::release( p, n );
+        }
+      
+      bool operator==( const LimbAllocator& ) const
+        {
+           return true;
+        }
+      
+      bool operator!=( const LimbAllocator& ) const
+        {
+           return false;
+        }
+   };
 }
 
-template< int W, typename u128, typename l > LargeInteger< W, u128 > operator-( l i, const LargeInteger< W, u128 >& j )
+/* A monotonic arena for the limbs of DynamicLargeInteger values created by
+ * a bounded computation, through ArenaAllocator. Allocations take the next
+ * limbs of the current block, blocks doubling in size as needed, freeing a
+ * value does nothing and release() frees all the blocks at once. The values
+ * must not be used after the release. An arena is meant to be used by a
+ * single thread.
+ */
+class LimbArena
 {
-   return -j + i;
-}
+ public:
+   explicit LimbArena( size_t initialLimbs = 1024 ) : current( NULL ), left( 0 ), next( initialLimbs ), initial( initialLimbs )
+     {
+     }
+   
+   ~LimbArena()
+     {
+        release();
+     }
+   
+   uint64_t* allocate( size_t n )
+     {
+        if( n > left )
+          {
+             size_t size = next > n ? next : n;
+             blocks.push_back( NULL );
+             blocks.back() = new uint64_t[ size ];
+             current = blocks.back();
+             left = size;
+             next = 2 * size;
+          }
+        uint64_t* p = current;
+        current += n;
+        left -= n;
+        return p;
+     }
+   
+   void release()
+     {
+        for( size_t i = 0; i < blocks.size(); ++i ) delete[] blocks[ i ];
+        blocks.clear();
+        current = NULL;
+        left = 0;
+        next = initial;
+     }
+   
+   LimbArena( const LimbArena& ) = delete;
+   LimbArena& operator=( const LimbArena& ) = delete;
+   
+ private:
+   std::vector< uint64_t* > blocks;
+   uint64_t* current;
+   size_t left;
+   size_t next;
+   size_t initial;
+};
+
+/* Allocator of DynamicLargeInteger taking the limbs from a LimbArena, as in
+ * DynamicLargeInteger< 4, ArenaAllocator > x( arena ).
+ */
+class ArenaAllocator
+{
+ public:
+   typedef uint64_t value_type;
+   
+   ArenaAllocator( LimbArena& arena ) : arena( &arena )
+     {
+     }
+   
+   uint64_t* allocate( size_t n )
+     {
+        return arena->allocate( n );
+     }
+   
+   void deallocate( uint64_t*, size_t )
+     {
+     }
+   
+   bool operator==( const ArenaAllocator& a ) const
+     {
+        return arena == a.arena;
+     }
+   
+   bool operator!=( const ArenaAllocator& a ) const
+     {
+        return arena != a.arena;
+     }
+   
+ private:
+   LimbArena* arena;
+};
+
+/* A signed integer whose number of limbs follows its value, for values
+ * whose size is not known in advance or varies a lot: a LargeInteger< 4096 >
+ * holding 42 still goes through its 64 limbs, a DynamicLargeInteger through
+ * a single one. The value is a sign and a magnitude stored most significant
+ * limb first, without leading zero limbs, so that the LargeInteger kernels
+ * apply unchanged. Up to N limbs are stored inline, larger magnitudes use
+ * buffers from Allocator, a standard allocator of uint64_t. The default one
+ * takes them from multiint_detail::LimbPool, ArenaAllocator from a
+ * LimbArena and, with C++17, std::pmr::polymorphic_allocator from a memory
+ * resource (see PmrDynamicLargeInteger).
+ *
+ * A value keeps the allocator it was built with, copies and the results of
+ * the operators use the allocator of their left operand, as well as the
+ * scratch limbs of the divisions. Assigning a value with another allocator
+ * copies its limbs.
+ *
+ * Divisions round toward zero like the built-in types and right shifts
+ * round toward minus infinity like the ones of LargeInteger. Conversions
+ * from and to LargeInteger are explicit, toInteger() wraps the value to W
+ * bits the way the LargeInteger arithmetic does.
+ */
+template< int N = 4, class Allocator = multiint_detail::LimbAllocator > class DynamicLargeInteger : private Allocator
+{
+   static_assert( N > 0, "At least one inline limb is required" );
+   
+   typedef std::allocator_traits< Allocator > Traits;
+   
+ public:
+   DynamicLargeInteger( const Allocator& a = Allocator() ) : Allocator( a ), p( small ), n( 0 ), capacity( N ), neg( false )
+     {
+     }
+   
+   DynamicLargeInteger( int64_t i, const Allocator& a = Allocator() ) : Allocator( a ), p( small ), n( 0 ), capacity( N ), neg( false )
+     {
+        assign( i < 0 ? -(uint64_t)i : i, i < 0 );
+     }
+   
+   DynamicLargeInteger( uint64_t i, const Allocator& a = Allocator() ) : Allocator( a ), p( small ), n( 0 ), capacity( N ), neg( false )
+     {
+        assign( i, false );
+     }
+   
+   DynamicLargeInteger( int32_t i, const Allocator& a = Allocator() ) : DynamicLargeInteger( (int64_t)i, a )
+     {
+     }
+   
+   DynamicLargeInteger( uint32_t i, const Allocator& a = Allocator() ) : DynamicLargeInteger( (uint64_t)i, a )
+     {
+     }
+   
+   DynamicLargeInteger( const std::string& s, const Allocator& a = Allocator() ) : Allocator( a ), p( small ), n( 0 ), capacity( N ), neg( false )
+     {
+        parse( s );
+     }
+   
+   template< int W, typename u128, bool S > explicit DynamicLargeInteger( const LargeInteger< W, u128, S >& x, const Allocator& a = Allocator() )
+     : Allocator( a ), p( small ), n( 0 ), capacity( N ), neg( false )
+       {
+          LargeInteger< W, u128, false > m = multiint_detail::magnitude_of( x );
+          int k = ( m.bitLength() + 63 ) / 64;
+          std::copy( m.limbs() + m.L - k, m.limbs() + m.L, reserve( k ) );
+          n = k;
+          neg = x.isNegative();
+       }
+   
+   DynamicLargeInteger( const DynamicLargeInteger& x ) : Allocator( x ), p( small ), n( 0 ), capacity( N ), neg( false )
+     {
+        *this = x;
+     }
+   
+   DynamicLargeInteger( DynamicLargeInteger&& x ) : Allocator( x ), p( small ), n( 0 ), capacity( N ), neg( false )
+     {
+        take( x );
+     }
+   
+   ~DynamicLargeInteger()
+     {
+        releaseLimbs();
+     }
+   
+   DynamicLargeInteger& operator=( const DynamicLargeInteger& x )
+     {
+        if( this != &x )
+          {
+             std::copy( x.p, x.p + x.n, reserve( x.n ) );
+             n = x.n;
+             neg = x.neg;
+          }
+        return *this;
+     }
+   
+   DynamicLargeInteger& operator=( DynamicLargeInteger&& x )
+     {
+        if( this != &x )
+          {
+             if( getAllocator() != x.getAllocator() ) return *this = (const DynamicLargeInteger&)x;
+             releaseLimbs();
+             take( x );
+          }
+        return *this;
+     }
+   
+   Allocator getAllocator() const
+     {
+        return *this;
+     }
+   
+   template< int W, typename u128 = uint128_t, bool S = true > LargeInteger< W, u128, S > toInteger() const
+     {
+        LargeInteger< W, u128, false > m;
+        int k = n < m.L ? n : m.L;
+        std::copy( p + n - k, p + n, m.limbs() + m.L - k );
+        return multiint_detail::with_sign< LargeInteger< W, u128, S > >( m, neg );
+     }
+   
+   bool isNegative() const
+     {
+        return neg;
+     }
+   
+   bool isPositive() const
+     {
+        return n && !neg;
+     }
+   
+   bool isZero() const
+     {
+        return n == 0;
+     }
+   
+   /* Number of limbs of the magnitude, 0 for zero. */
+   int significantLimbs() const
+     {
+        return n;
+     }
+   
+   /* Number of bits of the magnitude, 0 for zero. */
+   int bitLength() const
+     {
+        return n ? 64 * n - multiint_detail::clz_1( p[ 0 ] ) : 0;
+     }
+   
+   /* The limbs of the magnitude, most significant first. */
+   const uint64_t* limbs() const
+     {
+        return p;
+     }
+   
+   DynamicLargeInteger operator-() const
+     {
+        DynamicLargeInteger res( *this );
+        res.neg = n && !neg;
+        return res;
+     }
+   
+   DynamicLargeInteger operator+( const DynamicLargeInteger& y ) const
+     {
+        DynamicLargeInteger res( getAllocator() );
+        res.addSigned( *this, y, y.neg );
+        return res;
+     }
+   
+   DynamicLargeInteger operator-( const DynamicLargeInteger& y ) const
+     {
+        DynamicLargeInteger res( getAllocator() );
+        res.addSigned( *this, y, y.n && !y.neg );
+        return res;
+     }
+   
+   DynamicLargeInteger operator*( const DynamicLargeInteger& y ) const
+     {
+        DynamicLargeInteger res( getAllocator() );
+        if( n && y.n )
+          {
+             multiint_detail::mul_n( res.reserve( n + y.n ), p, n, y.p, y.n );
+             res.n = n + y.n;
+             res.neg = neg != y.neg;
+             res.normalize();
+          }
+        return res;
+     }
+   
+   DynamicLargeInteger operator/( const DynamicLargeInteger& y ) const
+     {
+        DynamicLargeInteger q( getAllocator() ), r( getAllocator() );
+        divRem( *this, y, q, r );
+        return q;
+     }
+   
+   DynamicLargeInteger operator%( const DynamicLargeInteger& y ) const
+     {
+        DynamicLargeInteger q( getAllocator() ), r( getAllocator() );
+        divRem( *this, y, q, r );
+        return r;
+     }
+   
+   DynamicLargeInteger operator<<( int s ) const
+     {
+        DynamicLargeInteger res( getAllocator() );
+        if( n == 0 ) return res;
+        int m = n + ( s + 63 ) / 64;
+        uint64_t* r = res.reserve( m );
+        std::fill( r, r + m - n, 0 );
+        std::copy( p, p + n, r + m - n );
+        multiint_detail::lshift_or( r, r, s, NULL, m );
+        res.n = m;
+        res.neg = neg;
+        res.normalize();
+        return res;
+     }
+   
+   DynamicLargeInteger operator>>( int s ) const
+     {
+        if( s >= 64 * n ) return DynamicLargeInteger( neg ? -1 : 0, getAllocator() );
+        
+        DynamicLargeInteger res( getAllocator() );
+        multiint_detail::rshift_fill( res.reserve( n ), p, s, 0, n );
+        res.n = n;
+        res.neg = neg;
+        
+        /* Rounds toward minus infinity when bits of a negative value are
+         * shifted out. The shifted magnitude is below 2^(64n-1), so the
+         * increment does not overflow.
+         */
+        if( neg && s )
+          {
+             bool lost = ( p[ n-1 - s/64 ] << ( 63 - s%64 ) << 1 ) != 0;
+             for( int k = 0; k < s/64 && !lost; ++k ) lost = p[ n-1 - k ] != 0;
+             if( lost ) multiint_detail::incr_n( res.p, n );
+          }
+        res.normalize();
+        return res;
+     }
+   
+   DynamicLargeInteger& operator+=( const DynamicLargeInteger& y )
+     {
+        return *this = *this + y;
+     }
+   
+   DynamicLargeInteger& operator-=( const DynamicLargeInteger& y )
+     {
+        return *this = *this - y;
+     }
+   
+   DynamicLargeInteger& operator*=( const DynamicLargeInteger& y )
+     {
+        return *this = *this * y;
+     }
+   
+   DynamicLargeInteger& operator/=( const DynamicLargeInteger& y )
+     {
+        return *this = *this / y;
+     }
+   
+   DynamicLargeInteger& operator%=( const DynamicLargeInteger& y )
+     {
+        return *this = *this % y;
+     }
+   
+   DynamicLargeInteger& operator<<=( int s )
+     {
+        return *this = *this << s;
+     }
+   
+   DynamicLargeInteger& operator>>=( int s )
+     {
+        return *this = *this >> s;
+     }
+   
+   /* Operations with a built-in integer, converted with the allocator of
+    * *this so that allocators without a default constructor also work.
+    */
+   template< typename l > typename std::enable_if< std::is_integral< l >::value, DynamicLargeInteger >::type operator+( l y ) const
+     {
+        return *this + operand( y );
+     }
+   
+   template< typename l > typename std::enable_if< std::is_integral< l >::value, DynamicLargeInteger >::type operator-( l y ) const
+     {
+        return *this - operand( y );
+     }
+   
+   template< typename l > typename std::enable_if< std::is_integral< l >::value, DynamicLargeInteger >::type operator*( l y ) const
+     {
+        return *this * operand( y );
+     }
+   
+   template< typename l > typename std::enable_if< std::is_integral< l >::value, DynamicLargeInteger >::type operator/( l y ) const
+     {
+        return *this / operand( y );
+     }
+   
+   template< typename l > typename std::enable_if< std::is_integral< l >::value, DynamicLargeInteger >::type operator%( l y ) const
+     {
+        return *this % operand( y );
+     }
+   
+   template< typename l > typename std::enable_if< std::is_integral< l >::value, DynamicLargeInteger& >::type operator+=( l y )
+     {
+        return *this = *this + operand( y );
+     }
+   
+   template< typename l > typename std::enable_if< std::is_integral< l >::value, DynamicLargeInteger& >::type operator-=( l y )
+     {
+        return *this = *this - operand( y );
+     }
+   
+   template< typename l > typename std::enable_if< std::is_integral< l >::value, DynamicLargeInteger& >::type operator*=( l y )
+     {
+        return *this = *this * operand( y );
+     }
+   
+   template< typename l > typename std::enable_if< std::is_integral< l >::value, DynamicLargeInteger& >::type operator/=( l y )
+     {
+        return *this = *this / operand( y );
+     }
+   
+   template< typename l > typename std::enable_if< std::is_integral< l >::value, DynamicLargeInteger& >::type operator%=( l y )
+     {
+        return *this = *this % operand( y );
+     }
+   
+   /* q = a / b and r = a - q b, which has the sign of a. q and r must be
+    * different variables but either may be a or b. Throws
+    * std::invalid_argument when b is zero.
+    */
+   static void divRem( const DynamicLargeInteger& a, const DynamicLargeInteger& b, DynamicLargeInteger& q, DynamicLargeInteger& r )
+     {
+        if( b.n == 0 ) throw std::invalid_argument( "Division by zero" );
+        
+        DynamicLargeInteger qt( a.getAllocator() ), rt( a.getAllocator() );
+        if( a.n < b.n ) rt = a;
+        else if( b.n == 1 )
+          {
+             uint64_t rem = multiint_detail::divrem_1( qt.reserve( a.n ), a.p, b.p[ 0 ], a.n );
+             qt.n = a.n;
+             rt.assign( rem, a.neg );
+          }
+        else
+          {
+             DynamicLargeInteger u( a.getAllocator() ), v( a.getAllocator() );
+             multiint_detail::divrem_n( qt.reserve( a.n + 1 - b.n ), rt.reserve( b.n ), a.p, a.n, b.p, b.n, u.reserve( a.n + 1 ), v.reserve( b.n ) );
+             qt.n = a.n + 1 - b.n;
+             rt.n = b.n;
+             rt.neg = a.neg;
+          }
+        qt.neg = a.neg != b.neg;
+        qt.normalize();
+        rt.normalize();
+        q = std::move( qt );
+        r = std::move( rt );
+     }
+   
+   /* -1, 0 or 1 as *this is lower than, equal to or greater than y. */
+   int compare( const DynamicLargeInteger& y ) const
+     {
+        if( neg != y.neg ) return neg ? -1 : 1;
+        int c = compareMagnitude( *this, y );
+        return neg ? -c : c;
+     }
+   
+   bool operator==( const DynamicLargeInteger& y ) const
+     {
+        return neg == y.neg && compareMagnitude( *this, y ) == 0;
+     }
+   
+   bool operator!=( const DynamicLargeInteger& y ) const
+     {
+        return !( *this == y );
+     }
+   
+   bool operator<( const DynamicLargeInteger& y ) const
+     {
+        return compare( y ) < 0;
+     }
+   
+   bool operator<=( const DynamicLargeInteger& y ) const
+     {
+        return compare( y ) <= 0;
+     }
+   
+   bool operator>( const DynamicLargeInteger& y ) const
+     {
+        return compare( y ) > 0;
+     }
+   
+   bool operator>=( const DynamicLargeInteger& y ) const
+     {
+        return compare( y ) >= 0;
+     }
+   
+   template< typename l > typename std::enable_if< std::is_integral< l >::value, bool >::type operator==( l y ) const
+     {
+        return *this == operand( y );
+     }
+   
+   template< typename l > typename std::enable_if< std::is_integral< l >::value, bool >::type operator!=( l y ) const
+     {
+        return *this != operand( y );
+     }
+   
+   template< typename l > typename std::enable_if< std::is_integral< l >::value, bool >::type operator<( l y ) const
+     {
+        return *this < operand( y );
+     }
+   
+   template< typename l > typename std::enable_if< std::is_integral< l >::value, bool >::type operator<=( l y ) const
+     {
+        return *this <= operand( y );
+     }
+   
+   template< typename l > typename std::enable_if< std::is_integral< l >::value, bool >::type operator>( l y ) const
+     {
+        return *this > operand( y );
+     }
+   
+   template< typename l > typename std::enable_if< std::is_integral< l >::value, bool >::type operator>=( l y ) const
+     {
+        return *this >= operand( y );
+     }
+   
+   operator std::string() const
+     {
+        if( n == 0 ) return "0";
+        std::string s;
+        if( neg ) s += '-';
+        DynamicLargeInteger tmp( *this );
+        multiint_detail::append_decimal( s, tmp.p, tmp.n );
+        return s;
+     }
+   
+   /* Hexadecimal digits of the magnitude, preceded by - for a negative
+    * value.
+    */
+   std::string toHexString() const
+     {
+        if( n == 0 ) return "0";
+        
+        std::stringstream ss;
+        if( neg ) ss << '-';
+        ss << std::hex << p[ 0 ] << std::setfill( '0' );
+        for( int i = 1; i < n; ++i ) ss << std::setw( 16 ) << p[ i ];
+        return ss.str();
+     }
+   
+ private:
+   template< typename l > DynamicLargeInteger operand( l y ) const
+     {
+        typedef typename std::conditional< std::is_signed< l >::value, int64_t, uint64_t >::type T;
+        return DynamicLargeInteger( (T)y, getAllocator() );
+     }
+   
+   /* Makes room for at least m limbs, the previous ones are lost. The size
+    * is rounded up to a power of two so that growing values reallocate a
+    * logarithmic number of times.
+    */
+   uint64_t* reserve( int m )
+     {
+        if( m > capacity )
+          {
+             releaseLimbs();
+             n = 0;
+             int size = 1;
+             while( size < m ) size *= 2;
+             p = Traits::allocate( *this, size );
+             capacity = size;
+          }
+        return p;
+     }
+   
+   void releaseLimbs()
+     {
+        if( p != small ) Traits::deallocate( *this, p, capacity );
+        p = small;
+        capacity = N;
+     }
+   
+   /* Moves the limbs of x, which has the same allocator. */
+   void take( DynamicLargeInteger& x )
+     {
+        if( x.p == x.small ) std::copy( x.small, x.small + x.n, small );
+        else
+          {
+             p = x.p;
+             capacity = x.capacity;
+             x.p = x.small;
+             x.capacity = N;
+          }
+        n = x.n;
+        neg = x.neg;
+        x.n = 0;
+        x.neg = false;
+     }
+   
+   void assign( uint64_t m, bool negative )
+     {
+        n = m != 0;
+        p[ 0 ] = m;
+        neg = negative && n;
+     }
+   
+   /* Drops the leading zero limbs, zero is never negative. */
+   void normalize()
+     {
+        int k = 0;
+        while( k < n && p[ k ] == 0 ) ++k;
+        if( k )
+          {
+             std::copy( p + k, p + n, p );
+             n -= k;
+          }
+        if( n == 0 ) neg = false;
+     }
+   
+   static int compareMagnitude( const DynamicLargeInteger& a, const DynamicLargeInteger& b )
+     {
+        if( a.n != b.n ) return a.n < b.n ? -1 : 1;
+        for( int i = 0; i < a.n; ++i )
+          if( a.p[ i ] != b.p[ i ] ) return a.p[ i ] < b.p[ i ] ? -1 : 1;
+        return 0;
+     }
+   
+   /* *this = a + b where the sign of b is replaced by bneg. *this must be
+    * another variable than a and b.
+    */
+   void addSigned( const DynamicLargeInteger& a, const DynamicLargeInteger& b, bool bneg )
+     {
+        const DynamicLargeInteger* x = &a;
+        const DynamicLargeInteger* y = &b;
+        if( a.neg == bneg )
+          {
+             if( x->n < y->n ) std::swap( x, y );
+             uint64_t* r = reserve( x->n + 1 );
+             r[ 0 ] = 0;
+             std::copy( x->p, x->p + x->n, r + 1 );
+             int d = x->n - y->n;
+             if( multiint_detail::add_n( r + 1 + d, r + 1 + d, y->p, y->n ) ) multiint_detail::incr_n( r, d + 1 );
+             n = x->n + 1;
+             neg = a.neg;
+          }
+        else
+          {
+             int c = compareMagnitude( a, b );
+             if( c < 0 ) std::swap( x, y );
+             uint64_t* r = reserve( x->n );
+             std::copy( x->p, x->p + x->n, r );
+             int d = x->n - y->n;
+             if( multiint_detail::sub_n( r + d, r + d, y->p, y->n ) ) multiint_detail::decr_n( r, d );
+             n = x->n;
+             neg = c < 0 ? bneg : a.neg;
+          }
+        normalize();
+     }
+   
+   void parse( const std::string& s )
+     {
+        uint64_t base = 10;
+        size_t i = 0;
+        bool minus = false;
+        if( s.length() > 1 && s[ 0 ] == '0' && tolower( s[ 1 ] ) == 'x' )
+          {
+             base = 16;
+             i = 2;
+          }
+        else if( s.length() > 0 && s[ 0 ] == '0' )
+          {
+             base = 8;
+             i = 1;
+          }
+        else if( s.length() > 0 && s[ 0 ] == '-' )
+          {
+             minus = true;
+             i = 1;
+          }
+        
+        /* Digits are gathered in single limb chunks, each one then multiplies
+         * the limbs found so far, which are kept at the end of the buffer.
+         */
+        int m = ( s.length() - i ) * ( base == 8 ? 3 : 4 ) / 64 + 1;
+        uint64_t* r = reserve( m );
+        int used = 0;
+        while( i < s.length() )
+          {
+             uint64_t chunk = 0, mult = 1;
+             for( ; i < s.length() && mult <= ~0ULL / base; ++i )
+               {
+                  uint64_t val = 16;
+                  char c = tolower( s[ i ] );
+                  if( c >= '0' && c <= '9' ) val = c - '0';
+                  else if( c >= 'a' && c <= 'f' ) val = 10 + c - 'a';
+                  if( val >= base ) throw number_format_error( "Number could not be parsed" );
+                  chunk = chunk * base + val;
+                  mult *= base;
+               }
+             uint64_t carry = multiint_detail::muladd_1( r + m - used, r + m - used, mult, chunk, used );
+             if( carry ) r[ m - ++used ] = carry;
+          }
+        std::copy( r + m - used, r + m, r );
+        n = used;
+        neg = minus && n;
+     }
+   
+   uint64_t* p;
+   int n;
+   int capacity;
+   bool neg;
+   uint64_t small[ N ];
+};
 
-template< int W, typename u128, typename l > LargeInteger< W, u128 > operator*( l i, const LargeInteger< W, u128 >& j )
+template< int N, class A > std::ostream& operator<<( std::ostream& os, const DynamicLargeInteger< N, A >& i )
 {
-   return j * i;
+   if( ( os.flags() & os.basefield ) == os.hex ) return os << i.toHexString();
+   return os << ( std::string )i;
 }
 
-template< int W, typename u128, typename l > LargeInteger< W, u128 > operator/( l i, const LargeInteger< W, u128 >& j )
-{
-   return LargeInteger< W, u128 >( i ) / j;
-}
+#ifdef MULTIINT_HAS_PMR
+/* DynamicLargeInteger taking its limbs from a std::pmr::memory_resource,
+ * for instance a std::pmr::monotonic_buffer_resource released at the end of
+ * a request: PmrDynamicLargeInteger<> x( 42, &resource ).
+ */
+template< int N = 4 > using PmrDynamicLargeInteger = DynamicLargeInteger< N, std::pmr::polymorphic_allocator< uint64_t > >;
+#endif
 
-template< int W, typename u128, typename l > l operator%( l i, const LargeInteger< W, u128 >& j )
+#ifdef MULTIINT_HAS_CONSTEXPR
+namespace multiint_detail
 {
-   return (l)(LargeInteger< W, u128 >( i ) % j).toUInt64();
+   /* Same bits, other signedness. */
+   template< bool T, int W, bool S > constexpr LargeInteger< W, uint128_t, T > limb_cast( const LargeInteger< W, uint128_t, S >& x )
+     {
+        LargeInteger< W, uint128_t, T > res;
+        for( int k = 0; k < res.L; ++k ) res.limbs()[ k ] = x.limbs()[ k ];
+        return res;
+     }
+   
+   /* 2^(2W) mod m, from 2^W mod m doubled W times. */
+   template< int W > constexpr LargeInteger< W, uint128_t, false > mont_r2( const LargeInteger< W, uint128_t, false >& m )
+     {
+        LargeInteger< W, uint128_t, false > r = ( LargeInteger< W, uint128_t, false >() - m ) % m;
+        for( int i = 0; i < W; ++i )
+          {
+             LargeInteger< W, uint128_t, false > d = r + r;
+             if( d < r ) d -= m;
+             else csub_n( d.limbs(), m.limbs(), d.L );
+             r = d;
+          }
+        return r;
+     }
 }
 
-template< int W, typename u128 > std::ostream& operator<<( std::ostream& os, const LargeInteger< W, u128 >& i )
+/* Integers modulo M, an odd constant of W bits given as a reference to a
+ * constexpr UnsignedLargeInteger, so that all the W bits can be used:
+ *
+ *   constexpr UnsignedLargeInteger<256> P = UnsignedLargeInteger<256>( -1 ) - 0x1000003D0;
+ *   typedef ModInt< 256, P > Fp;
+ *
+ * Values are kept reduced, in Montgomery form, and the Montgomery
+ * constants are computed at compile time. Apart from division and
+ * inverse(), which throw not_invertible_error for values not coprime with
+ * M, all the operations are constexpr.
+ */
+template< int W, const LargeInteger< W, uint128_t, false >& M > class ModInt
 {
-   std::string prefix;
-   std::string number;
+ public:
+   typedef LargeInteger< W, uint128_t, false > Integer;
+   static const int L = Integer::L;
    
-   if( ( os.flags() & os.basefield ) == os.dec )
+   static_assert( M.testBit( 0 ) && M != Integer( 1 ), "The modulus must be odd and greater than 1" );
+   
+   constexpr ModInt() : v()
      {
-        if( ( os.flags() & os.showpos ) && !i.isNegative() ) prefix = "+";
-        number = ( std::string )i;
-        if( i.isNegative() )
-          {
-             prefix = "-";
-             number = number.substr( 1 );
-          }
      }
-   else if( ( os.flags() & os.basefield ) == os.hex )
+   
+   constexpr ModInt( int64_t i ) : v( toMont( reduce( LargeInteger< W >( i ) ) ) )
      {
-        if( os.flags() & os.showbase ) prefix = "0x";
-        number = i.toHexString();
-        if( os.flags() & os.uppercase )
+     }
+   
+   template< bool S > constexpr ModInt( const LargeInteger< W, uint128_t, S >& x ) : v( toMont( reduce( x ) ) )
+     {
+     }
+   
+   static constexpr Integer modulus()
+     {
+        return m;
+     }
+   
+   /* The value between 0 and M-1. */
+   constexpr Integer value() const
+     {
+        return mul( v, Integer( 1 ) );
+     }
+   
+   constexpr ModInt operator+( const ModInt& b ) const
+     {
+        ModInt res;
+        res.v = v + b.v;
+        if( res.v < v ) res.v -= m;
+        else multiint_detail::csub_n( res.v.limbs(), m.limbs(), L );
+        return res;
+     }
+   
+   constexpr ModInt operator-( const ModInt& b ) const
+     {
+        ModInt res;
+        res.v = v - b.v;
+        if( v < b.v ) res.v += m;
+        return res;
+     }
+   
+   constexpr ModInt operator-() const
+     {
+        return ModInt() - *this;
+     }
+   
+   constexpr ModInt operator*( const ModInt& b ) const
+     {
+        ModInt res;
+        res.v = mul( v, b.v );
+        return res;
+     }
+   
+   ModInt operator/( const ModInt& b ) const
+     {
+        return *this * b.inverse();
+     }
+   
+   constexpr ModInt& operator+=( const ModInt& b )
+     {
+        return *this = *this + b;
+     }
+   
+   constexpr ModInt& operator-=( const ModInt& b )
+     {
+        return *this = *this - b;
+     }
+   
+   constexpr ModInt& operator*=( const ModInt& b )
+     {
+        return *this = *this * b;
+     }
+   
+   ModInt& operator/=( const ModInt& b )
+     {
+        return *this = *this / b;
+     }
+   
+   constexpr bool operator==( const ModInt& b ) const
+     {
+        return v == b.v;
+     }
+   
+   constexpr bool operator!=( const ModInt& b ) const
+     {
+        return v != b.v;
+     }
+   
+   /* A negative exponent raises the inverse, which is not constexpr. */
+   template< bool S > constexpr ModInt pow( const LargeInteger< W, uint128_t, S >& e ) const
+     {
+        if( e.isNegative() ) return inverse().pow( multiint_detail::limb_cast< false >( -e ) );
+        ModInt res;
+        res.v = r1;
+        for( int i = e.bitLength() - 1; i >= 0; --i )
           {
-             if( prefix.length() ) prefix = "0X";
-             std::transform( number.begin(), number.end(), number.begin(), ::toupper );
+             res.v = mul( res.v, res.v );
+             if( e.testBit( i ) ) res.v = mul( res.v, v );
           }
+        return res;
      }
-   else if( ( os.flags() & os.basefield ) == os.oct )
+   
+   ModInt inverse() const
      {
-        if( os.flags() & os.showbase ) number = "0";
-        number += i.toOctString();
+        return ModInt( multiint_detail::invmod_u( value(), m ) );
      }
    
-   if( os.width() > prefix.length() + number.length() )
+ private:
+   Integer v;
+   
+   static constexpr Integer m = M;
+   static constexpr uint64_t minv = multiint_detail::neg_inverse_1( m.limbs()[ L-1 ] );
+   static constexpr Integer r1 = ( Integer() - m ) % m;
+   static constexpr Integer r2 = multiint_detail::mont_r2( m );
+   
+   template< bool S > static constexpr Integer reduce( const LargeInteger< W, uint128_t, S >& x )
      {
-        std::string sfill( os.width() - prefix.length() - number.length(), os.fill() );
-        
-        if( ( os.flags() & os.adjustfield ) == os.internal )
-          os << ( prefix + sfill + number );
-        else if( ( os.flags() & os.adjustfield ) == os.left )
-          os << ( prefix + number + sfill );
-        else if( ( os.flags() & os.adjustfield ) == os.right )
-          os << ( sfill + prefix + number );
+        Integer r = multiint_detail::limb_cast< false >( x.isNegative() ? -x : x ) % m;
+        return x.isNegative() && r.isPositive() ? m - r : r;
      }
-   else
+   
+   static constexpr Integer mul( const Integer& a, const Integer& b )
      {
-        os << ( prefix + number );
+        uint64_t t[ 2*L ] = {};
+        multiint_detail::mul_n( t, a.limbs(), L, b.limbs(), L );
+        Integer res;
+        multiint_detail::redc_n( res.limbs(), t, m.limbs(), minv, L );
+        return res;
      }
    
-   return os;
-}
+   static constexpr Integer toMont( const Integer& a )
+     {
+        return mul( a, r2 );
+     }
+};
+
+template< int W, const LargeInteger< W, uint128_t, false >& M > constexpr typename ModInt< W, M >::Integer ModInt< W, M >::m;
+template< int W, const LargeInteger< W, uint128_t, false >& M > constexpr uint64_t ModInt< W, M >::minv;
+template< int W, const LargeInteger< W, uint128_t, false >& M > constexpr typename ModInt< W, M >::Integer ModInt< W, M >::r1;
+template< int W, const LargeInteger< W, uint128_t, false >& M > constexpr typename ModInt< W, M >::Integer ModInt< W, M >::r2;
+#endif
 
-template< int W, typename u128 > std::istream& operator>>( std::istream& is, LargeInteger< W, u128 >& i )
+#ifdef MULTIINT_HAS_CONSTEXPR
+namespace multiint_detail
 {
-   std::istream::sentry sen( is, false );
-   if( sen )
-     {
-        std::string s;
-        if( ( is.flags() & is.basefield ) == is.dec )
+   /* Compile time parsing of the digits of an integer literal. The same
+    * prefixes as the string constructor are accepted, plus 0b for binary
+    * and the ' digit separator. A literal that does not fit in the integer
+    * is rejected.
+    */
+   template< int W > constexpr LargeInteger< W > parseLiteral( const char* s, int n )
+     {
+        uint64_t base = 10;
+        int i = 0;
+        if( n > 1 && s[ 0 ] == '0' && ( s[ 1 ] == 'x' || s[ 1 ] == 'X' ) )
           {
-             if( is.good() )
-               {
-                  if( is.peek() == '-' )
-                    {
-                       char c = is.get();
-                       s += c;
-                    }
-                  else if( is.peek() == '+' ) is.get();
-               }
-             while( is.good() )
-               {
-                  char c = is.peek();
-                  if( c == EOF ) break;
-                  if( c >= '0' && c <= '9' ) s += c;
-                  else break;
-                  is.get();
-               }
-             i = s;
+             base = 16;
+             i = 2;
           }
-        else if( ( is.flags() & is.basefield ) == is.hex )
+        else if( n > 1 && s[ 0 ] == '0' && ( s[ 1 ] == 'b' || s[ 1 ] == 'B' ) )
           {
-             s = "0x";
-             if( is.good() && is.peek() == '0' )
-               {
-                  is.get();
-                  if( is.good() && is.peek() == 'x' ) is.get();
-                  else s += '0';
-               }
-             while( is.good() )
-               {
-                  char c = is.peek();
-                  if( c == EOF ) break;
-                  if( c >= '0' && c <= '9' ) s += c;
-                  else if( tolower(c) >= 'a' && tolower(c) <= 'z' ) s += c;
-                  else break;
-                  is.get();
-               }
-             i = s;
+             base = 2;
+             i = 2;
           }
-        else if( ( is.flags() & is.basefield ) == is.oct )
+        else if( s[ 0 ] == '0' )
           {
-             s = "0";
-             if( is.good() && is.peek() == '0' )
-               is.get();
-             while( is.good() )
-               {
-                  char c = is.peek();
-                  if( c == EOF ) break;
-                  if( c >= '0' && c <= '7' ) s += c;
-                  else break;
-                  is.get();
-               }
-             i = s;
+             base = 8;
+             i = 1;
           }
+        
+        LargeInteger< W > res;
+        for( ; i < n; ++i )
+          {
+             char c = s[ i ];
+             if( c == '\'' ) continue;
+             
+             uint64_t val = 16;
+             if( c >= '0' && c <= '9' ) val = c - '0';
+             else if( c >= 'a' && c <= 'f' ) val = 10 + c - 'a';
+             else if( c >= 'A' && c <= 'F' ) val = 10 + c - 'A';
+             if( val >= base ) throw number_format_error( "Number could not be parsed" );
+             
+             if( muladd_1( res.limbs(), res.limbs(), base, val, LargeInteger< W >::L ) != 0 )
+               throw number_format_error( "Number is too large for the integer width" );
+          }
+        return res;
      }
    
-   return is;
+   /* The value is a static constexpr member so it is always computed by the
+    * compiler and lives in read only data, even when the literal is not
+    * used in a constant expression.
+    */
+   template< int W, char... C > struct Literal
+     {
+        static constexpr char digits[ sizeof...( C ) ] = { C... };
+        static constexpr LargeInteger< W > value = parseLiteral< W >( digits, sizeof...( C ) );
+     };
+   
+   template< int W, char... C > constexpr char Literal< W, C... >::digits[];
+   template< int W, char... C > constexpr LargeInteger< W > Literal< W, C... >::value;
+}
+
+/* Defines the _L<W> literal suffix for LargeInteger< W >, so that
+ * 0xffffffff00000001_L256 is a compile time constant. The usual widths are
+ * defined below, other ones can be added with this macro.
+ */
+#define MULTIINT_LITERAL( W )                                           \
+template< char... C > constexpr LargeInteger< W > operator""_L##W()     \
+{                                                                       \
+   return multiint_detail::Literal< W, C... >::value;                  \
 }
 
+MULTIINT_LITERAL( 128 )
+MULTIINT_LITERAL( 192 )
+MULTIINT_LITERAL( 256 )
+MULTIINT_LITERAL( 384 )
+MULTIINT_LITERAL( 512 )
+MULTIINT_LITERAL( 1024 )
+MULTIINT_LITERAL( 2048 )
+MULTIINT_LITERAL( 3072 )
+MULTIINT_LITERAL( 4096 )
+MULTIINT_LITERAL( 8192 )
+#endif
+
 #endif // MULTIINT_HPP
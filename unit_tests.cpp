@@ -1,6 +1,7 @@
 
 #include <gtest/gtest.h>
 #include <gmpxx.h>
+#include <vector>
 
 #include "multiint.hpp"
 
@@ -260,6 +261,23 @@ TEST(LargeIntegerTest, Modulo)
    ASSERT_DEATH( i1 % LargeInteger<1024>(), "" );
    
    ASSERT_EQ( (string)( i1 / i3 ).getRemaining(), mpz_class( i1gmp % i3gmp ).get_str() );
+   
+   auto q = i1 / i3;
+   ASSERT_NE( q.getRemaining(), 0 );
+   q = q * 2;
+   ASSERT_EQ( (string)q, mpz_class( i1gmp / i3gmp * 2 ).get_str() );
+   ASSERT_EQ( q.getRemaining(), 0 );
+   q = i1 / 7;
+   ASSERT_EQ( (string)q.getRemaining(), mpz_class( i1gmp % 7 ).get_str() );
+   q += 1;
+   ASSERT_EQ( (string)q, mpz_class( i1gmp / 7 + 1 ).get_str() );
+   ASSERT_EQ( q.getRemaining(), 0 );
+   q = i1 / 7;
+   q <<= 3;
+   ASSERT_EQ( q.getRemaining(), 0 );
+   q = i1 / 7;
+   ASSERT_EQ( (string)q++, mpz_class( i1gmp / 7 ).get_str() );
+   ASSERT_EQ( q.getRemaining(), 0 );
 }
 
 TEST(LargeIntegerTest, Increments)
@@ -676,3 +694,1048 @@ TEST(LargeIntegerTest, InputStreams)
    ASSERT_EQ( i, j );
    ASSERT_EQ( LargeInteger<1024>( 0 ), k );
 }
+
+TEST(LargeIntegerTest, LazyExpressions)
+{
+   string s1 = "2324562324354654768987455344234356324354656757858568764654657657587686786786";
+   string s2 = "-122435843953723954234958473942043735374349544738992998187456783424737538394220";
+   string s3 = "0x12e243F58439537239542349584A739420437353743b49544738992998187456c783424737538394220";
+   LargeInteger<1024> i1 = s1;
+   LargeInteger<1024> i2 = s2;
+   LargeInteger<1024> i3 = s3;
+   mpz_class i1gmp( s1 );
+   mpz_class i2gmp( s2 );
+   
+   LargeInteger<1024> j = lazy( i1 ) * 4354657576 + i2;
+   ASSERT_EQ( (string)j, mpz_class( i1gmp * mpz_class( 4354657576 ) + i2gmp ).get_str() );
+   
+   j = lazy( i1 ) * -4354657576 + i2;
+   ASSERT_EQ( (string)j, mpz_class( i1gmp * mpz_class( -4354657576 ) + i2gmp ).get_str() );
+   
+   ASSERT_EQ( ( lazy( i2 ) * 12345 ).eval(), i2 * 12345 );
+   
+   j = lazy( i1 ) * i2 + i3;
+   ASSERT_EQ( j, i1 * i2 + i3 );
+   ASSERT_EQ( ( lazy( i2 ) * i3 ).eval(), i2 * i3 );
+   
+   j = i1;
+   j = lazy( j ) * j + i1;
+   ASSERT_EQ( j, i1 * i1 + i1 );
+   
+   ASSERT_EQ( ( ( lazy( i3 ) << 67 ) | i1 ).eval(), ( i3 << 67 ) | i1 );
+   ASSERT_EQ( ( ( lazy( i3 ) << 128 ) | i1 ).eval(), ( i3 << 128 ) | i1 );
+   ASSERT_EQ( ( lazy( i3 ) << 5 ).eval(), i3 << 5 );
+   ASSERT_EQ( ( ( lazy( i3 ) << 1024 ) | i1 ).eval(), i1 );
+   
+   j = i3;
+   j = ( lazy( j ) << 3 ) | j;
+   ASSERT_EQ( j, ( i3 << 3 ) | i3 );
+}
+
+#ifdef MULTIINT_HAS_CONSTEXPR
+TEST(LargeIntegerTest, Constexpr)
+{
+   constexpr LargeInteger<256> p = 0x7fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffed_L256;
+   constexpr LargeInteger<256> p2 = ( LargeInteger<256>( 1 ) << 255 ) - 19;
+   static_assert( p == p2, "compile time literal" );
+   static_assert( p > 0 && -p < 0, "compile time comparison" );
+   static_assert( ( p / 3 ) * 3 + p % LargeInteger<256>( 3 ) == p, "compile time arithmetic" );
+   static_assert( p % LargeInteger<256>( 1000000007 ) == p % (uint64_t)1000000007, "compile time modulo" );
+   static_assert( 1'000'000_L128 == 1000000, "digit separators" );
+   static_assert( 0b1011_L128 == 11 && 0777_L128 == 511, "binary and octal literals" );
+   
+   constexpr LargeInteger<1024> q = 122435843953723954234958473942043735374349544738992998187456783424737538394220_L1024;
+   ASSERT_EQ( (string)q, "122435843953723954234958473942043735374349544738992998187456783424737538394220" );
+   ASSERT_EQ( (string)p, mpz_class( mpz_class( 1 ) * ( mpz_class( 1 ) << 255 ) - 19 ).get_str() );
+   
+   constexpr LargeInteger<1024> r = ( q / 1234567 ).getRemaining();
+   ASSERT_EQ( (string)r, mpz_class( mpz_class( (string)q ) % 1234567 ).get_str() );
+}
+#endif
+
+template< uint64_t D > static void checkConstantDivision( const LargeInteger<1024>& i )
+{
+   mpz_class igmp( (string)i );
+   ASSERT_EQ( i.divBy<D>(), i / (uint64_t)D );
+   ASSERT_EQ( (string)i.divBy<D>(), mpz_class( igmp / mpz_class( (unsigned long)D ) ).get_str() );
+   ASSERT_EQ( i.divBy<D>().getRemaining(), ( i / (uint64_t)D ).getRemaining() );
+   ASSERT_EQ( i.modBy<D>(), i % (uint64_t)D );
+}
+
+TEST(LargeIntegerTest, ConstantDivision)
+{
+   string s1 = "2324562324354654768987455344234356324354656757858568764654657657587686786786";
+   string s2 = "-122435843953723954234958473942043735374349544738992998187456783424737538394220";
+   string s3 = "0x12e243F58439537239542349584A739420437353743b49544738992998187456c783424737538394220";
+   LargeInteger<1024> values[] = { s1, s2, s3, LargeInteger<1024>( 0 ), LargeInteger<1024>( 42 ) };
+   
+   for( int k = 0; k < 5; ++k )
+     {
+        checkConstantDivision< 1 >( values[ k ] );
+        checkConstantDivision< 2 >( values[ k ] );
+        checkConstantDivision< 3 >( values[ k ] );
+        checkConstantDivision< 10 >( values[ k ] );
+        checkConstantDivision< 1024 >( values[ k ] );
+        checkConstantDivision< 4294967291ULL >( values[ k ] );
+        checkConstantDivision< 4294967296ULL >( values[ k ] );
+        checkConstantDivision< 1000000007 >( values[ k ] );
+        checkConstantDivision< 10000000000000000000ULL >( values[ k ] );
+        checkConstantDivision< 0x8000000000000001ULL >( values[ k ] );
+        checkConstantDivision< 0xFFFFFFFFFFFFFFFFULL >( values[ k ] );
+     }
+   
+   ASSERT_EQ( (string)values[ 0 ], s1 );
+   ASSERT_EQ( (string)LargeInteger<1024>( "10000000000000000000" ), "10000000000000000000" );
+   ASSERT_EQ( (string)LargeInteger<1024>( "100000000000000000000000000000000000000" ), "100000000000000000000000000000000000000" );
+}
+
+TEST(LargeIntegerTest, InvariantDivisor)
+{
+   string s1 = "2324562324354654768987455344234356324354656757858568764654657657587686786786";
+   string s2 = "-122435843953723954234958473942043735374349544738992998187456783424737538394220";
+   LargeInteger<1024> i1 = s1;
+   LargeInteger<1024> i2 = s2;
+   uint64_t divisors[] = { 1, 2, 3, 7, 10, 4354657576ULL, 1000000007, 0x8000000000000000ULL, 0xFFFFFFFFFFFFFFFFULL };
+   
+   for( int k = 0; k < 9; ++k )
+     {
+        Divisor64 d( divisors[ k ] );
+        ASSERT_EQ( d.divisor(), divisors[ k ] );
+        ASSERT_EQ( i1.divRem( d ), i1 / divisors[ k ] );
+        ASSERT_EQ( i1.divRem( d ).getRemaining(), ( i1 / divisors[ k ] ).getRemaining() );
+        ASSERT_EQ( i2 / d, i2 / divisors[ k ] );
+        ASSERT_EQ( ( i2 / d ).getRemaining(), ( i2 / divisors[ k ] ).getRemaining() );
+        ASSERT_EQ( i1 % d, i1 % divisors[ k ] );
+        ASSERT_EQ( i2 % d, i2 % divisors[ k ] );
+        ASSERT_EQ( (string)( i1 / d ), mpz_class( mpz_class( s1 ) / mpz_class( (unsigned long)divisors[ k ] ) ).get_str() );
+     }
+   
+   LargeInteger<1024> j = i1;
+   j /= Divisor64( 10 );
+   ASSERT_EQ( j, i1 / 10 );
+   
+   ASSERT_THROW( Divisor64( 0 ), std::invalid_argument );
+}
+
+TEST(LargeIntegerTest, SmallValuesInWideIntegers)
+{
+   string s1 = "2324562324354654768987455344234356324354656757858568764654657657587686786786";
+   string s2 = "-1224358439537239542349584739420437";
+   LargeInteger<4096> i1 = s1;
+   LargeInteger<4096> i2 = s2;
+   mpz_class i1gmp( s1 );
+   mpz_class i2gmp( s2 );
+   
+   ASSERT_EQ( (string)( i1 * i2 ), mpz_class( i1gmp * i2gmp ).get_str() );
+   ASSERT_EQ( (string)( i2 * i2 ), mpz_class( i2gmp * i2gmp ).get_str() );
+   ASSERT_EQ( (string)( i1 / i2 ), mpz_class( i1gmp / i2gmp ).get_str() );
+   ASSERT_EQ( (string)( i2 / i1 ), mpz_class( i2gmp / i1gmp ).get_str() );
+   ASSERT_EQ( (string)( i1 % i2 ), mpz_class( i1gmp % i2gmp ).get_str() );
+   ASSERT_EQ( (string)( i1 * LargeInteger<4096>( 0 ) ), "0" );
+   ASSERT_EQ( (string)( LargeInteger<4096>( 0 ) / i1 ), "0" );
+   
+   LargeInteger<4096> values[] = { LargeInteger<4096>( 0 ), LargeInteger<4096>( 42 ), LargeInteger<4096>( -42 ), i2 };
+   for( int k = 0; k < 4; ++k )
+     {
+        mpz_class v( (string)values[ k ] );
+        ASSERT_EQ( (string)( values[ k ] / 5 ), mpz_class( v / 5 ).get_str() );
+        ASSERT_EQ( (string)( values[ k ] / -5 ), mpz_class( v / -5 ).get_str() );
+        ASSERT_EQ( (string)( values[ k ] / (uint64_t)5 ).getRemaining(), mpz_class( v % 5 ).get_str() );
+        ASSERT_EQ( (string)values[ k ].divBy< 7 >(), mpz_class( v / 7 ).get_str() );
+        ASSERT_EQ( (string)values[ k ].divBy< 8 >().getRemaining(), mpz_class( v % 8 ).get_str() );
+        ASSERT_EQ( (int64_t)values[ k ].modBy< 7 >(), mpz_class( v % 7 ).get_si() );
+        ASSERT_EQ( (string)values[ k ].divRem( Divisor64( 11 ) ).getRemaining(), mpz_class( v % 11 ).get_str() );
+        ASSERT_EQ( (string)( values[ k ] / Divisor64( 11 ) ), mpz_class( v / 11 ).get_str() );
+        ASSERT_EQ( (int64_t)( values[ k ] % Divisor64( 11 ) ), mpz_class( v % 11 ).get_si() );
+     }
+   
+   LargeInteger<4096> big = ( LargeInteger<4096>( 1 ) << 4000 ) + 12345;
+   mpz_class biggmp = ( mpz_class( 1 ) << 4000 ) + 12345;
+   ASSERT_EQ( (string)( big / i1 ), mpz_class( biggmp / i1gmp ).get_str() );
+   ASSERT_EQ( (string)( big % i2 ), mpz_class( biggmp % i2gmp ).get_str() );
+   ASSERT_EQ( (string)big, biggmp.get_str() );
+   
+   LargeInteger<1024> h( "0x100000000000000000000000000000005" );
+   ASSERT_EQ( h.toHexString(), "100000000000000000000000000000005" );
+   ASSERT_EQ( LargeInteger<1024>( 0 ).toHexString(), "0" );
+   ASSERT_EQ( LargeInteger<1024>( 0 ).toOctString(), "0" );
+   ASSERT_EQ( LargeInteger<1024>( 8 ).toOctString(), "10" );
+   ASSERT_EQ( LargeInteger<1024>( "0x1000000000000000000000000" ).toOctString(), mpz_class( "0x1000000000000000000000000" ).get_str( 8 ) );
+}
+
+TEST(LargeIntegerTest, SingleLimbOperands)
+{
+   string s1 = "2324562324354654768987455344234356324354656757858568764654657657587686786786";
+   LargeInteger<1024> i1 = s1;
+   mpz_class i1gmp( s1 );
+   string values[] = { "18446744073709551615", "-18446744073709551615", "4354657576", "-7",
+                       "340282366920938463463374607431768211455", "-18446744073709551617", "1",
+                       "6277101735386680763835789423207666416102355444464034512896", "-340282366920938463463374607431768211456",
+                       "340282366920938463463374607431768211457" };
+   
+   for( int k = 0; k < 10; ++k )
+     {
+        LargeInteger<1024> v( values[ k ] );
+        mpz_class vgmp( values[ k ] );
+        ASSERT_EQ( (string)( v * v ), mpz_class( vgmp * vgmp ).get_str() );
+        ASSERT_EQ( (string)( i1 * v ), mpz_class( i1gmp * vgmp ).get_str() );
+        ASSERT_EQ( (string)( v * i1 ), mpz_class( i1gmp * vgmp ).get_str() );
+        ASSERT_EQ( (string)( i1 / v ), mpz_class( i1gmp / vgmp ).get_str() );
+        ASSERT_EQ( (string)( i1 % v ), mpz_class( i1gmp % vgmp ).get_str() );
+        for( int m = 0; m < 10; ++m )
+          {
+             LargeInteger<1024> w( values[ m ] );
+             mpz_class wgmp( values[ m ] );
+             ASSERT_EQ( (string)( v / w ), mpz_class( vgmp / wgmp ).get_str() );
+             ASSERT_EQ( (string)( v % w ), mpz_class( vgmp % wgmp ).get_str() );
+          }
+     }
+   
+   LargeInteger<64> a( 123456789 );
+   ASSERT_EQ( a * a, LargeInteger<64>( (uint64_t)123456789 * 123456789 ) );
+   ASSERT_EQ( ( a * a ) / a, a );
+   ASSERT_EQ( LargeInteger<256>( 5 ) % ( LargeInteger<256>( 1 ) << 192 ), LargeInteger<256>( 5 ) );
+   ASSERT_EQ( invmod( LargeInteger<256>( 3 ), ( LargeInteger<256>( 1 ) << 192 ) + 1 ) * 3 % ( ( LargeInteger<256>( 1 ) << 192 ) + 1 ), LargeInteger<256>( 1 ) );
+}
+
+TEST(LargeIntegerTest, SignedMultiplication)
+{
+   mpz_class modulus = mpz_class( 1 ) << 256;
+   mpz_class half = mpz_class( 1 ) << 255;
+   string values[] = { "-1", "-7", "-4354657576", "-18446744073709551615", "-18446744073709551616",
+                       "-9223372036854775808", "9223372036854775808", "-9223372036854775809",
+                       "-340282366920938463463374607431768211456", "170141183460469231731687303715884105728",
+                       "-2324562324354654768987455344234356324354656757858568764654657",
+                       "57896044618658097711785492504343953926634992332820282019728792003956564819967",
+                       "-57896044618658097711785492504343953926634992332820282019728792003956564819968" };
+   
+   for( int k = 0; k < 13; ++k )
+     {
+        LargeInteger<256> v( values[ k ] );
+        mpz_class vgmp( values[ k ] );
+        for( int m = 0; m < 13; ++m )
+          {
+             LargeInteger<256> w( values[ m ] );
+             mpz_class r = mpz_class( vgmp * mpz_class( values[ m ] ) ) % modulus;
+             if( r < 0 ) r += modulus;
+             if( r >= half ) r -= modulus;
+             ASSERT_EQ( (string)( v * w ), r.get_str() );
+          }
+        mpz_class r = mpz_class( vgmp * mpz_class( "-4354657576" ) ) % modulus;
+        if( r < 0 ) r += modulus;
+        if( r >= half ) r -= modulus;
+        ASSERT_EQ( (string)( v * (int64_t)-4354657576LL ), r.get_str() );
+     }
+   
+   ASSERT_EQ( LargeInteger<64>( -3 ) * LargeInteger<64>( 5 ), LargeInteger<64>( -15 ) );
+   ASSERT_EQ( LargeInteger<128>( INT64_MIN ) * INT64_MIN, LargeInteger<128>( 1 ) << 126 );
+}
+
+TEST(LargeIntegerTest, TruncatedMultiplication)
+{
+   mpz_class modulus = mpz_class( 1 ) << 512;
+   gmp_randclass rnd( gmp_randinit_default );
+   rnd.seed( 12345 );
+   
+   for( int k = 0; k < 200; ++k )
+     {
+        mpz_class agmp = rnd.get_z_bits( 64 + ( k * 37 ) % 449 );
+        mpz_class bgmp = rnd.get_z_bits( 64 + ( k * 91 ) % 449 );
+        UnsignedLargeInteger<512> a( agmp.get_str() );
+        UnsignedLargeInteger<512> b( bgmp.get_str() );
+        mpz_class r = mpz_class( agmp * bgmp ) % modulus;
+        ASSERT_EQ( (string)( a * b ), r.get_str() );
+        a *= b;
+        ASSERT_EQ( (string)a, r.get_str() );
+     }
+}
+
+/* Conversions through the limbs, faster than strings for very wide values. */
+template< int W, bool S > static mpz_class toMpz( const LargeInteger< W, uint128_t, S >& x )
+{
+   mpz_class r;
+   mpz_import( r.get_mpz_t(), x.L, 1, 8, 0, 0, x.limbs() );
+   if( S && x.isNegative() ) r -= mpz_class( 1 ) << W;
+   return r;
+}
+
+template< int W > static LargeInteger< W > fromMpz( const mpz_class& x )
+{
+   mpz_class m = x & ( ( mpz_class( 1 ) << W ) - 1 );
+   LargeInteger< W > r;
+   size_t count = ( mpz_sizeinbase( m.get_mpz_t(), 2 ) + 63 ) / 64;
+   mpz_export( r.limbs() + r.L - count, NULL, 1, 8, 0, 0, m.get_mpz_t() );
+   return r;
+}
+
+TEST(LargeIntegerTest, NttMultiplication)
+{
+   gmp_randclass rnd( gmp_randinit_default );
+   rnd.seed( 46 );
+   mpz_class modulus = mpz_class( 1 ) << 65536;
+   for( int k = 0; k < 4; ++k )
+     {
+        mpz_class agmp = rnd.get_z_bits( 65536 - 1000 * k ), bgmp = rnd.get_z_bits( 60000 + 1000 * k );
+        if( k & 1 ) agmp = -agmp;
+        LargeInteger<65536> a = fromMpz<65536>( agmp ), b = fromMpz<65536>( bgmp );
+        ASSERT_EQ( toMpz( a ), agmp );
+        mpz_class r = mpz_class( agmp * bgmp ) % modulus;
+        if( r < 0 ) r += modulus;
+        if( r >= ( modulus >> 1 ) ) r -= modulus;
+        ASSERT_EQ( toMpz( a * b ), r );
+        r = mpz_class( agmp * agmp ) % modulus;
+        if( r >= ( modulus >> 1 ) ) r -= modulus;
+        ASSERT_EQ( toMpz( a * a ), r );
+        
+        LargeInteger<32768> c = fromMpz<32768>( rnd.get_z_bits( 32767 ) ), d = fromMpz<32768>( -rnd.get_z_bits( 30000 + 500 * k ) );
+        ASSERT_EQ( toMpz( mulWide( c, d ) ), toMpz( c ) * toMpz( d ) );
+     }
+   
+   LargeInteger<65536> m = LargeInteger<65536>( -1 );
+   ASSERT_EQ( m * m, LargeInteger<65536>( 1 ) );
+   UnsignedLargeInteger<32768> u = UnsignedLargeInteger<32768>( -1 );
+   ASSERT_EQ( toMpz( mulWide( u, u ) ), toMpz( u ) * toMpz( u ) );
+}
+
+TEST(LargeIntegerTest, ParallelMultiplication)
+{
+   gmp_randclass rnd( gmp_randinit_default );
+   rnd.seed( 47 );
+   mpz_class agmp = rnd.get_z_bits( 262144 ), bgmp = -rnd.get_z_bits( 262000 );
+   LargeInteger<262144> a = fromMpz<262144>( agmp ), b = fromMpz<262144>( bgmp );
+   LargeInteger<262144> serial = a * b;
+   mpz_class modulus = mpz_class( 1 ) << 262144;
+   mpz_class r = mpz_class( agmp * bgmp ) % modulus;
+   if( r < 0 ) r += modulus;
+   if( r >= ( modulus >> 1 ) ) r -= modulus;
+   ASSERT_EQ( toMpz( serial ), r );
+   
+   for( int threads = 2; threads <= 7; threads += 5 )
+     {
+        setMultiplicationThreads( threads );
+        ASSERT_EQ( a * b, serial );
+        ASSERT_EQ( a * a, fromMpz<262144>( agmp * agmp ) );
+        setMultiplicationThreads( threads, 0 );
+        LargeInteger<32768> c = fromMpz<32768>( agmp ), d = fromMpz<32768>( bgmp );
+        ASSERT_EQ( toMpz( mulWide( c, d ) ), toMpz( c ) * toMpz( d ) );
+        setMultiplicationThreads( threads, 0, 256 );
+        ASSERT_EQ( toMpz( mulWide( c, d ) ), toMpz( c ) * toMpz( d ) );
+     }
+   setMultiplicationThreads( 1 );
+}
+
+TEST(LargeIntegerTest, NewtonDivision)
+{
+   gmp_randclass rnd( gmp_randinit_default );
+   rnd.seed( 48 );
+   for( int k = 0; k < 4; ++k )
+     {
+        mpz_class agmp = rnd.get_z_bits( 262143 - 20000 * k ), bgmp = rnd.get_z_bits( 100000 + 15000 * k ) + 1;
+        if( k & 1 ) agmp = -agmp;
+        if( k & 2 ) bgmp = -bgmp;
+        LargeInteger<262144> a = fromMpz<262144>( agmp ), b = fromMpz<262144>( bgmp );
+        mpz_class q = agmp / bgmp;
+        ASSERT_EQ( toMpz( a / b ), q );
+        ASSERT_EQ( toMpz( a % b ), agmp - q * bgmp );
+        ASSERT_EQ( string( a ), agmp.get_str() );
+     }
+
+   /* A divisor whose reciprocal is a power of two and a remainder of one
+    * below the divisor.
+    */
+   mpz_class dgmp = mpz_class( 1 ) << 120000;
+   mpz_class ngmp = dgmp * ( ( mpz_class( 1 ) << 130000 ) - 1 ) - 1;
+   LargeInteger<262144> n = fromMpz<262144>( ngmp ), d = fromMpz<262144>( dgmp );
+   ASSERT_EQ( toMpz( n / d ), ngmp / dgmp );
+   ASSERT_EQ( toMpz( n % d ), dgmp - 1 );
+   d -= 1;
+   ASSERT_EQ( toMpz( n / d ), ngmp / ( dgmp - 1 ) );
+   ASSERT_EQ( toMpz( n % d ), ngmp % ( dgmp - 1 ) );
+
+   mpz_class tgmp;
+   mpz_ui_pow_ui( tgmp.get_mpz_t(), 10, 78000 );
+   ASSERT_EQ( string( fromMpz<262144>( tgmp ) ), tgmp.get_str() );
+   ASSERT_EQ( string( fromMpz<262144>( tgmp - 1 ) ), string( 78000, '9' ) );
+   ASSERT_EQ( string( fromMpz<262144>( -tgmp - 1 ) ), "-" + mpz_class( tgmp + 1 ).get_str() );
+}
+
+TEST(LargeIntegerTest, WordShifts)
+{
+   string s1 = "-2324562324354654768987455344234356324354656757858568764654657657587686786786";
+   LargeInteger<512> i1 = s1;
+   UnsignedLargeInteger<512> u1 = s1;
+   mpz_class i1gmp( s1 );
+   mpz_class modulus = mpz_class( 1 ) << 512;
+   mpz_class u1gmp = i1gmp + modulus;
+   
+   for( int l = 0; l < 600; l += 7 )
+     {
+        mpz_class r = mpz_class( i1gmp << l ) % modulus;
+        if( r < 0 ) r += modulus;
+        if( r >= ( modulus >> 1 ) ) r -= modulus;
+        ASSERT_EQ( (string)( i1 << l ), r.get_str() );
+        ASSERT_EQ( (string)( i1 >> l ), mpz_class( i1gmp >> l ).get_str() );
+        ASSERT_EQ( (string)( u1 >> l ), mpz_class( u1gmp >> l ).get_str() );
+        LargeInteger<512> i2 = i1;
+        i2 >>= l;
+        ASSERT_EQ( i2, i1 >> l );
+        i2 = i1;
+        i2 <<= l;
+        ASSERT_EQ( i2, i1 << l );
+     }
+   
+   ASSERT_EQ( i1.shl<0>(), i1 );
+   ASSERT_EQ( i1.shl<64>(), i1 << 64 );
+   ASSERT_EQ( i1.shl<131>(), i1 << 131 );
+   ASSERT_EQ( i1.shr<63>(), i1 >> 63 );
+   ASSERT_EQ( i1.shr<200>(), i1 >> 200 );
+   ASSERT_EQ( u1.shr<511>(), UnsignedLargeInteger<512>( 1 ) );
+}
+
+TEST(LargeIntegerTest, Compare)
+{
+   gmp_randclass rnd( gmp_randinit_default );
+   rnd.seed( 4321 );
+   std::vector< LargeInteger<2048> > v;
+   std::vector< mpz_class > vgmp;
+   for( int k = 0; k < 100; ++k )
+     {
+        mpz_class x = rnd.get_z_bits( 1 + ( k * 53 ) % 2000 );
+        if( k % 3 == 0 ) x = -x;
+        v.push_back( LargeInteger<2048>( x.get_str() ) );
+        vgmp.push_back( x );
+     }
+   v.push_back( v[ 10 ] );
+   vgmp.push_back( vgmp[ 10 ] );
+   
+   for( size_t i = 0; i < v.size(); ++i )
+     for( size_t j = 0; j < v.size(); ++j )
+       {
+          int c = cmp( vgmp[ i ], vgmp[ j ] );
+          ASSERT_EQ( v[ i ].compare( v[ j ] ) < 0, c < 0 );
+          ASSERT_EQ( v[ i ].compare( v[ j ] ) > 0, c > 0 );
+          ASSERT_EQ( v[ i ] == v[ j ], c == 0 );
+          ASSERT_EQ( v[ i ] != v[ j ], c != 0 );
+          ASSERT_EQ( v[ i ] < v[ j ], c < 0 );
+          ASSERT_EQ( v[ i ] <= v[ j ], c <= 0 );
+          ASSERT_EQ( v[ i ] > v[ j ], c > 0 );
+          ASSERT_EQ( v[ i ] >= v[ j ], c >= 0 );
+#ifdef MULTIINT_HAS_THREE_WAY_COMPARISON
+          ASSERT_EQ( ( v[ i ] <=> v[ j ] ) < 0, c < 0 );
+          ASSERT_EQ( ( v[ i ] <=> v[ j ] ) == 0, c == 0 );
+#endif
+       }
+   
+   std::sort( v.begin(), v.end() );
+   std::sort( vgmp.begin(), vgmp.end() );
+   for( size_t i = 0; i < v.size(); ++i ) ASSERT_EQ( (string)v[ i ], vgmp[ i ].get_str() );
+   
+   LargeInteger<2048> a = v[ 50 ];
+   LargeInteger<2048> b = a ^ ( LargeInteger<2048>( 1 ) << 2047 );
+   ASSERT_FALSE( a == b );
+   b = a ^ 1;
+   ASSERT_FALSE( a == b );
+   ASSERT_TRUE( ( b ^ 1 ) == a );
+   ASSERT_EQ( UnsignedLargeInteger<128>( -1 ).compare( UnsignedLargeInteger<128>( 1 ) ), 1 );
+}
+
+TEST(LargeIntegerTest, WideBitwise)
+{
+   gmp_randclass rnd( gmp_randinit_default );
+   rnd.seed( 777 );
+   mpz_class modulus = mpz_class( 1 ) << 8256;
+   mpz_class agmp = rnd.get_z_bits( 8256 );
+   mpz_class bgmp = rnd.get_z_bits( 8200 );
+   UnsignedLargeInteger<8256> a( agmp.get_str() );
+   UnsignedLargeInteger<8256> b( bgmp.get_str() );
+   
+   ASSERT_EQ( (string)( a & b ), mpz_class( agmp & bgmp ).get_str() );
+   ASSERT_EQ( (string)( a | b ), mpz_class( agmp | bgmp ).get_str() );
+   ASSERT_EQ( (string)( a ^ b ), mpz_class( agmp ^ bgmp ).get_str() );
+   ASSERT_EQ( (string)( ~a ), mpz_class( agmp ^ ( modulus - 1 ) ).get_str() );
+   ASSERT_EQ( (string)a.andNot( b ), mpz_class( agmp & ( bgmp ^ ( modulus - 1 ) ) ).get_str() );
+   
+   UnsignedLargeInteger<8256> c = a;
+   c &= b;
+   ASSERT_EQ( c, a & b );
+   c = a;
+   c |= b;
+   ASSERT_EQ( c, a | b );
+   c = a;
+   c ^= b;
+   ASSERT_EQ( c, a ^ b );
+   c = a;
+   c.andNotAssign( b );
+   ASSERT_EQ( c, a.andNot( b ) );
+   
+   UnsignedLargeInteger<8256> one( 1 );
+   UnsignedLargeInteger<8256> top = one << 8255;
+   ASSERT_TRUE( a.testAny( b ) );
+   ASSERT_FALSE( a.testAny( a.andNot( a ) ) );
+   ASSERT_TRUE( top.testAny( ~UnsignedLargeInteger<8256>() ) );
+   ASSERT_FALSE( top.testAny( one ) );
+   ASSERT_TRUE( one.isPositive() );
+   ASSERT_TRUE( top.isPositive() );
+   ASSERT_FALSE( UnsignedLargeInteger<8256>().isPositive() );
+}
+
+static int bitsOf( const mpz_class& x )
+{
+   return x == 0 ? 0 : (int)mpz_sizeinbase( x.get_mpz_t(), 2 );
+}
+
+TEST(LargeIntegerTest, Bits)
+{
+   gmp_randclass rnd( gmp_randinit_default );
+   rnd.seed( 99 );
+   mpz_class modulus = mpz_class( 1 ) << 320;
+   for( int k = 0; k < 40; ++k )
+     {
+        mpz_class x = rnd.get_z_bits( 1 + ( k * 29 ) % 319 );
+        if( k % 2 ) x = -x;
+        mpz_class raw = x < 0 ? mpz_class( x + modulus ) : x;
+        LargeInteger<320> i( x.get_str() );
+        
+        ASSERT_EQ( i.bitLength(), x < 0 ? bitsOf( -x - 1 ) : bitsOf( x ) );
+        ASSERT_EQ( i.countLeadingZeros(), 320 - bitsOf( raw ) );
+        if( x != 0 )
+          {
+             ASSERT_EQ( i.countTrailingZeros(), (int)mpz_scan1( raw.get_mpz_t(), 0 ) );
+          }
+        ASSERT_EQ( i.popCount(), (int)mpz_popcount( raw.get_mpz_t() ) );
+        for( int b = 0; b < 320; b += 13 )
+          {
+             ASSERT_EQ( i.testBit( b ), mpz_tstbit( raw.get_mpz_t(), b ) == 1 );
+             ASSERT_EQ( i.extractBits( b, 20 ), mpz_class( ( x >> b ) & 0xfffff ).get_ui() );
+             ASSERT_EQ( i.extractBits( b, 64 ), ( i >> b ).limbs()[ 4 ] );
+             LargeInteger<320> j = i;
+             j.flipBit( b );
+             ASSERT_EQ( j.testBit( b ), !i.testBit( b ) );
+             ASSERT_EQ( j ^ i, LargeInteger<320>( 1 ) << b );
+             j.setBit( b );
+             ASSERT_TRUE( j.testBit( b ) );
+             j.clearBit( b );
+             ASSERT_FALSE( j.testBit( b ) );
+             ASSERT_EQ( j | ( LargeInteger<320>( 1 ) << b ), i | ( LargeInteger<320>( 1 ) << b ) );
+          }
+     }
+   
+   ASSERT_EQ( LargeInteger<320>().countTrailingZeros(), 320 );
+   ASSERT_EQ( LargeInteger<320>().countLeadingZeros(), 320 );
+   ASSERT_EQ( LargeInteger<320>( -1 ).bitLength(), 0 );
+   ASSERT_EQ( LargeInteger<320>( -1 ).popCount(), 320 );
+   ASSERT_EQ( LargeInteger<320>( -1 ).extractBits( 300, 64 ), ~0ULL );
+   ASSERT_EQ( LargeInteger<320>( 5 ).extractBits( 300, 64 ), 0 );
+}
+
+template< int W > static void checkGcd( gmp_randclass& rnd, int bits )
+{
+   for( int k = 0; k < 30; ++k )
+     {
+        mpz_class common = rnd.get_z_bits( k % 5 == 0 ? bits / 3 : 8 );
+        mpz_class agmp = mpz_class( rnd.get_z_bits( bits - bits / 3 ) * common );
+        mpz_class bgmp = mpz_class( rnd.get_z_bits( bits - bits / 3 - ( k * 37 ) % ( bits / 2 ) ) * common );
+        if( k % 2 ) agmp = -agmp;
+        if( k % 3 == 1 ) bgmp = -bgmp;
+        if( k == 7 ) bgmp = 0;
+        LargeInteger<W> a( agmp.get_str() );
+        LargeInteger<W> b( bgmp.get_str() );
+        
+        mpz_class g, sgmp, tgmp;
+        mpz_gcd( g.get_mpz_t(), agmp.get_mpz_t(), bgmp.get_mpz_t() );
+        ASSERT_EQ( (string)gcd( a, b ), g.get_str() );
+        
+        LargeInteger<W> s, t;
+        ASSERT_EQ( (string)xgcd( a, b, s, t ), g.get_str() );
+        mpz_class sg( (string)s ), tg( (string)t );
+        ASSERT_EQ( mpz_class( agmp * sg + bgmp * tg ), g );
+        
+        mpz_class m = abs( bgmp ) + 1;
+        LargeInteger<W> mi( m.get_str() );
+        mpz_class inv;
+        if( mpz_invert( inv.get_mpz_t(), agmp.get_mpz_t(), m.get_mpz_t() ) )
+          ASSERT_EQ( (string)invmod( a, mi ), inv.get_str() );
+        else
+          ASSERT_THROW( invmod( a, mi ), not_invertible_error );
+     }
+}
+
+TEST(LargeIntegerTest, Gcd)
+{
+   gmp_randclass rnd( gmp_randinit_default );
+   rnd.seed( 2024 );
+   checkGcd<128>( rnd, 120 );
+   checkGcd<256>( rnd, 250 );
+   checkGcd<1024>( rnd, 1000 );
+   checkGcd<2048>( rnd, 2040 );
+   
+   ASSERT_EQ( gcd( LargeInteger<512>( 0 ), LargeInteger<512>( 0 ) ), LargeInteger<512>( 0 ) );
+   ASSERT_EQ( gcd( LargeInteger<512>( -12 ), LargeInteger<512>( 18 ) ), LargeInteger<512>( 6 ) );
+   ASSERT_EQ( gcd( UnsignedLargeInteger<256>( 12 ), UnsignedLargeInteger<256>( 18 ) ), UnsignedLargeInteger<256>( 6 ) );
+   ASSERT_EQ( invmod( LargeInteger<512>( -3 ), LargeInteger<512>( 7 ) ), LargeInteger<512>( 2 ) );
+   ASSERT_EQ( invmod( LargeInteger<512>( 5 ), LargeInteger<512>( 1 ) ), LargeInteger<512>( 0 ) );
+   ASSERT_THROW( invmod( LargeInteger<512>( 6 ), LargeInteger<512>( 9 ) ), not_invertible_error );
+   ASSERT_THROW( invmod( LargeInteger<512>( 6 ), LargeInteger<512>( 0 ) ), std::invalid_argument );
+}
+
+TEST(LargeIntegerTest, BatchInversion)
+{
+   gmp_randclass rnd( gmp_randinit_default );
+   rnd.seed( 5 );
+   mpz_class p( "115792089237316195423570985008687907853269984665640564039457584007908834671663" );
+   LargeInteger<512> m( p.get_str() );
+   
+   std::vector< LargeInteger<512> > x;
+   std::vector< mpz_class > xgmp;
+   for( int k = 0; k < 50; ++k )
+     {
+        mpz_class v = rnd.get_z_bits( 1 + ( k * 41 ) % 500 ) + 1;
+        if( k % 4 == 0 ) v = -v;
+        x.push_back( LargeInteger<512>( v.get_str() ) );
+        xgmp.push_back( v );
+     }
+   
+   mpz_class r;
+   ASSERT_EQ( (string)mulmod( x[ 3 ], x[ 5 ], m ), mpz_class( ( xgmp[ 3 ] * xgmp[ 5 ] ) % p ).get_str() );
+   r = xgmp[ 4 ] * xgmp[ 5 ] % p;
+   if( r < 0 ) r += p;
+   ASSERT_EQ( (string)mulmod( x[ 4 ], x[ 5 ], m ), r.get_str() );
+   
+   for( int threads = 1; threads <= 4; threads += 3 )
+     {
+        std::vector< LargeInteger<512> > y = x;
+        batchInvmod( &y[ 0 ], y.size(), m, threads );
+        for( size_t i = 0; i < y.size(); ++i )
+          {
+             mpz_invert( r.get_mpz_t(), xgmp[ i ].get_mpz_t(), p.get_mpz_t() );
+             ASSERT_EQ( (string)y[ i ], r.get_str() );
+          }
+     }
+   
+   std::vector< LargeInteger<512> > y = x;
+   y[ 20 ] = m * 3;
+   ASSERT_THROW( batchInvmod( &y[ 0 ], y.size(), m, 4 ), not_invertible_error );
+   ASSERT_EQ( y[ 0 ], x[ 0 ] );
+}
+
+TEST(LargeIntegerTest, Roots)
+{
+   gmp_randclass rnd( gmp_randinit_default );
+   rnd.seed( 31 );
+   for( int k = 0; k < 60; ++k )
+     {
+        mpz_class ngmp = rnd.get_z_bits( 1 + ( k * 67 ) % 2047 );
+        LargeInteger<2048> n( ngmp.get_str() );
+        mpz_class sgmp, rgmp;
+        mpz_sqrtrem( sgmp.get_mpz_t(), rgmp.get_mpz_t(), ngmp.get_mpz_t() );
+        LargeInteger<2048> r;
+        ASSERT_EQ( (string)isqrt( n ), sgmp.get_str() );
+        ASSERT_EQ( (string)isqrtRem( n, r ), sgmp.get_str() );
+        ASSERT_EQ( (string)r, rgmp.get_str() );
+        
+        unsigned e = 2 + k % 9;
+        mpz_root( rgmp.get_mpz_t(), ngmp.get_mpz_t(), e );
+        ASSERT_EQ( (string)iroot( n, e ), rgmp.get_str() );
+        if( e % 2 )
+          {
+             ASSERT_EQ( (string)iroot( -n, e ), mpz_class( -rgmp ).get_str() );
+          }
+        
+        ASSERT_EQ( isPerfectSquare( n ), mpz_perfect_square_p( ngmp.get_mpz_t() ) != 0 );
+        ASSERT_TRUE( isPerfectSquare( isqrt( n ) * isqrt( n ) ) );
+        ASSERT_FALSE( isPerfectSquare( isqrt( n ) * isqrt( n ) + 2 * isqrt( n ) + 1 + 1 ) );
+     }
+   
+   UnsignedLargeInteger<256> top( -1 );
+   mpz_class topgmp = ( mpz_class( 1 ) << 256 ) - 1;
+   ASSERT_EQ( (string)isqrt( top ), mpz_class( sqrt( topgmp ) ).get_str() );
+   ASSERT_EQ( isqrt( LargeInteger<512>( 0 ) ), LargeInteger<512>( 0 ) );
+   ASSERT_EQ( iroot( LargeInteger<512>( 7 ), 100 ), LargeInteger<512>( 1 ) );
+   ASSERT_THROW( isqrt( LargeInteger<512>( -4 ) ), std::invalid_argument );
+   ASSERT_THROW( iroot( LargeInteger<512>( -4 ), 4 ), std::invalid_argument );
+   ASSERT_FALSE( isPerfectSquare( LargeInteger<512>( -4 ) ) );
+}
+
+TEST(LargeIntegerTest, Primes)
+{
+   gmp_randclass rnd( gmp_randinit_default );
+   rnd.seed( 17 );
+   for( int k = 0; k < 20; ++k )
+     {
+        mpz_class ngmp = rnd.get_z_bits( 2 + ( k * 197 ) % 1000 );
+        LargeInteger<1024> n( ngmp.get_str() );
+        mpz_class p;
+        mpz_nextprime( p.get_mpz_t(), ngmp.get_mpz_t() );
+        ASSERT_EQ( isProbablePrime( n ), mpz_probab_prime_p( ngmp.get_mpz_t(), 30 ) != 0 );
+        ASSERT_EQ( (string)nextPrime( n ), p.get_str() );
+        ASSERT_EQ( (string)nextPrime( n, 0, 2 + k % 6 ), p.get_str() );
+        ASSERT_TRUE( isProbablePrime( nextPrime( n ), 5 ) );
+        
+        mpz_class e = rnd.get_z_bits( 300 );
+        mpz_class m = ngmp + 2;
+        mpz_class r;
+        mpz_powm( r.get_mpz_t(), mpz_class( ngmp + 12345 ).get_mpz_t(), e.get_mpz_t(), m.get_mpz_t() );
+        ASSERT_EQ( (string)powmod( n + 12345, LargeInteger<1024>( e.get_str() ), LargeInteger<1024>( m.get_str() ) ), r.get_str() );
+     }
+   
+   /* Strong pseudoprimes to base 2, and a Carmichael number. */
+   ASSERT_FALSE( isProbablePrime( LargeInteger<128>( 2047 ) ) );
+   ASSERT_FALSE( isProbablePrime( LargeInteger<128>( "3825123056546413051" ) ) );
+   ASSERT_FALSE( isProbablePrime( LargeInteger<128>( "318665857834031151167461" ) ) );
+   ASSERT_FALSE( isProbablePrime( LargeInteger<128>( 561 ) ) );
+   ASSERT_FALSE( isProbablePrime( LargeInteger<128>( -7 ) ) );
+   ASSERT_TRUE( isProbablePrime( LargeInteger<128>( 2 ) ) );
+   ASSERT_TRUE( isProbablePrime( LargeInteger<128>( 4093 ) ) );
+   ASSERT_TRUE( isProbablePrime( LargeInteger<128>( "170141183460469231731687303715884105727" ) ) );
+   ASSERT_TRUE( isProbablePrime( UnsignedLargeInteger<128>( "340282366920938463463374607431768211297" ), 10 ) );
+   ASSERT_EQ( nextPrime( LargeInteger<128>( -5 ) ), LargeInteger<128>( 2 ) );
+   ASSERT_EQ( nextPrime( LargeInteger<128>( 2 ) ), LargeInteger<128>( 3 ) );
+   ASSERT_EQ( nextPrime( LargeInteger<128>( 4091 ) ), LargeInteger<128>( 4093 ) );
+   ASSERT_EQ( nextPrime( LargeInteger<128>( 4091 ), 0, 64 ), LargeInteger<128>( 4093 ) );
+   ASSERT_THROW( nextPrime( UnsignedLargeInteger<128>( "340282366920938463463374607431768211297" ) ), std::overflow_error );
+   
+   mpz_class big = ( mpz_class( 1 ) << 1000 ) + 12345;
+   mpz_class p;
+   mpz_nextprime( p.get_mpz_t(), big.get_mpz_t() );
+   ASSERT_EQ( (string)nextPrime( LargeInteger<1024>( big.get_str() ), 0, 4 ), p.get_str() );
+   ASSERT_EQ( powmod( LargeInteger<256>( 3 ), LargeInteger<256>( -1 ), LargeInteger<256>( 10 ) ), LargeInteger<256>( 7 ) );
+   ASSERT_EQ( powmod( LargeInteger<256>( 3 ), LargeInteger<256>( 5 ), LargeInteger<256>( 1 ) ), LargeInteger<256>( 0 ) );
+}
+
+TEST(LargeIntegerTest, SpecialModulus)
+{
+   gmp_randclass rnd( gmp_randinit_default );
+   rnd.seed( 255 );
+   mpz_class p25519 = ( mpz_class( 1 ) << 255 ) - 19;
+   mpz_class p521 = ( mpz_class( 1 ) << 521 ) - 1;
+   mpz_class p64 = ( mpz_class( 1 ) << 64 ) - 59;
+   typedef SpecialModulus< 256, 255, 19 > F25519;
+   typedef SpecialModulus< 576, 521, 1 > F521;
+   typedef SpecialModulus< 64, 64, 59 > F64;
+   ASSERT_EQ( (string)F25519::modulus(), p25519.get_str() );
+   
+   for( int k = 0; k < 50; ++k )
+     {
+        mpz_class a = rnd.get_z_range( p25519 ), b = rnd.get_z_range( p25519 );
+        F25519::Integer ia( a.get_str() ), ib( b.get_str() );
+        ASSERT_EQ( (string)F25519::mul( ia, ib ), mpz_class( a * b % p25519 ).get_str() );
+        ASSERT_EQ( (string)F25519::add( ia, ib ), mpz_class( ( a + b ) % p25519 ).get_str() );
+        ASSERT_EQ( (string)F25519::sub( ia, ib ), mpz_class( ( a - b + p25519 ) % p25519 ).get_str() );
+        mpz_class w = rnd.get_z_bits( 512 );
+        ASSERT_EQ( (string)F25519::reduce( F25519::WideInteger( w.get_str() ) ), mpz_class( w % p25519 ).get_str() );
+        w = rnd.get_z_bits( 256 );
+        ASSERT_EQ( (string)F25519::reduce( F25519::Integer( w.get_str() ) ), mpz_class( w % p25519 ).get_str() );
+        
+        a = rnd.get_z_range( p521 );
+        b = rnd.get_z_range( p521 );
+        ASSERT_EQ( (string)F521::mul( F521::Integer( a.get_str() ), F521::Integer( b.get_str() ) ), mpz_class( a * b % p521 ).get_str() );
+        
+        a = rnd.get_z_range( p64 );
+        b = rnd.get_z_range( p64 );
+        ASSERT_EQ( (string)F64::mul( F64::Integer( a.get_str() ), F64::Integer( b.get_str() ) ), mpz_class( a * b % p64 ).get_str() );
+        ASSERT_EQ( (string)F64::add( F64::Integer( a.get_str() ), F64::Integer( b.get_str() ) ), mpz_class( ( a + b ) % p64 ).get_str() );
+        w = rnd.get_z_bits( 64 );
+        ASSERT_EQ( (string)F64::reduce( F64::Integer( w.get_str() ) ), mpz_class( w % p64 ).get_str() );
+     }
+   
+   /* Largest C allowed for K = 64, the modulus is 2^63 + 1. */
+   typedef SpecialModulus< 64, 64, 0x7FFFFFFFFFFFFFFFULL > F63;
+   ASSERT_EQ( (string)F63::reduce( F63::Integer( -1 ) ), mpz_class( ( ( mpz_class( 1 ) << 64 ) - 1 ) % ( ( mpz_class( 1 ) << 63 ) + 1 ) ).get_str() );
+   
+   mpz_class a( "-12345678901234567890123456789" ), b( "98765432109876543210987654321098765" );
+   ASSERT_EQ( (string)mulWide( LargeInteger<128>( a.get_str() ), LargeInteger<128>( b.get_str() ) ), mpz_class( a * b ).get_str() );
+   ASSERT_EQ( (string)mulWide( UnsignedLargeInteger<128>( -1 ), UnsignedLargeInteger<128>( -1 ) ),
+              mpz_class( ( ( mpz_class( 1 ) << 128 ) - 1 ) * ( ( mpz_class( 1 ) << 128 ) - 1 ) ).get_str() );
+   ASSERT_EQ( mulWide( LargeInteger<64>( INT64_MIN ), LargeInteger<64>( INT64_MIN ) ), LargeInteger<128>( 1 ) << 126 );
+}
+
+TEST(LargeIntegerTest, Rns)
+{
+   gmp_randclass rnd( gmp_randinit_default );
+   rnd.seed( 45 );
+   mpz_class half = mpz_class( 1 ) << 1023;
+   std::vector< LargeInteger<1024> > x( 20 );
+   std::vector< RnsInteger<1024> > rx( 20 );
+   for( int k = 0; k < 20; ++k ) x[ k ] = LargeInteger<1024>( mpz_class( rnd.get_z_bits( 1024 ) - half ).get_str() );
+   RnsInteger<1024>::fromIntegers( &x[ 0 ], &rx[ 0 ], x.size() );
+   
+   for( int k = 0; k + 3 < 20; ++k )
+     {
+        mpz_class a( (string)x[ k ] ), b( (string)x[ k+1 ] ), c( (string)x[ k+2 ] ), d( (string)x[ k+3 ] );
+        ASSERT_EQ( RnsInteger<1024>( x[ k ] ), rx[ k ] );
+        ASSERT_EQ( rx[ k ].toInteger(), x[ k ] );
+        RnsInteger<1024> e = rx[ k ] * rx[ k+1 ] - rx[ k+2 ] * rx[ k+3 ];
+        ASSERT_EQ( (string)e.toWide(), mpz_class( a * b - c * d ).get_str() );
+        ASSERT_EQ( e.toInteger(), x[ k ] * x[ k+1 ] - x[ k+2 ] * x[ k+3 ] );
+        UnsignedLargeInteger<1024> sum = ( rx[ k ] + rx[ k+1 ] ).toInteger< uint128_t, false >();
+        ASSERT_EQ( (string)sum, mpz_class( ( a + b ) & ( ( mpz_class( 1 ) << 1024 ) - 1 ) ).get_str() );
+        ASSERT_EQ( (string)( -rx[ k ] * rx[ k ] ).toWide(), mpz_class( -a * a ).get_str() );
+     }
+   
+   std::vector< LargeInteger<1024> > y( 20 );
+   RnsInteger<1024>::toIntegers( &rx[ 0 ], &y[ 0 ], rx.size() );
+   ASSERT_EQ( x, y );
+   
+   RnsInteger<64> i( -5 ), j( INT64_MAX ), z;
+   ASSERT_EQ( ( i * j ).toWide(), LargeInteger<128>( -5 ) * INT64_MAX );
+   ASSERT_EQ( ( i * j ).toInteger(), LargeInteger<64>( -5 ) * INT64_MAX );
+   ASSERT_EQ( ( i + 5 ), z );
+   ASSERT_EQ( i.residue( 0 ), RnsInteger<64>::Basis::get().p[ 0 ] - 5 );
+   ASSERT_EQ( ( j * j ).toWide(), mulWide( LargeInteger<64>( INT64_MAX ), LargeInteger<64>( INT64_MAX ) ) );
+}
+
+#ifdef MULTIINT_HAS_CONSTEXPR
+static constexpr UnsignedLargeInteger<256> modInt25519 = ( UnsignedLargeInteger<256>( 1 ) << 255 ) - 19;
+static constexpr UnsignedLargeInteger<128> modInt127 = ( UnsignedLargeInteger<128>( (uint64_t)0x5eadbeefcafebabe ) << 64 ) + (uint64_t)0x1234567890abcdef;
+static constexpr UnsignedLargeInteger<256> modIntSecp256k1 = UnsignedLargeInteger<256>( -1 ) - 0x1000003D0;
+
+TEST(LargeIntegerTest, ModInt)
+{
+   typedef ModInt< 256, modInt25519 > Fp;
+   typedef ModInt< 128, modInt127 > Fq;
+   typedef ModInt< 256, modIntSecp256k1 > Fs;
+   static_assert( ( Fp( 3 ) * Fp( 5 ) ).value() == 15, "compile time multiplication" );
+   static_assert( ( Fp( 3 ) - Fp( 5 ) ).value() == Fp::modulus() - 2, "compile time subtraction" );
+   static_assert( Fp( -1 ) + Fp( 1 ) == Fp( 0 ), "compile time addition" );
+   static_assert( Fp( 2 ).pow( Fp::modulus() - 1 ) == Fp( 1 ), "compile time exponentiation" );
+   static_assert( Fs( 3 ).pow( Fs::modulus() - 1 ) == Fs( 1 ), "compile time exponentiation" );
+   
+   gmp_randclass rnd( gmp_randinit_default );
+   rnd.seed( 44 );
+   mpz_class p( (string)modInt25519 ), q( (string)modInt127 ), s( (string)modIntSecp256k1 );
+   for( int k = 0; k < 50; ++k )
+     {
+        mpz_class a = rnd.get_z_bits( 255 ), b = rnd.get_z_range( p ), e = rnd.get_z_bits( 200 );
+        Fp fa( LargeInteger<256>( a.get_str() ) ), fb( UnsignedLargeInteger<256>( b.get_str() ) );
+        ASSERT_EQ( (string)( fa * fb ).value(), mpz_class( a * b % p ).get_str() );
+        ASSERT_EQ( (string)( fa + fb ).value(), mpz_class( ( a + b ) % p ).get_str() );
+        ASSERT_EQ( (string)( fa - fb ).value(), mpz_class( ( a - b + 2 * p ) % p ).get_str() );
+        ASSERT_EQ( (string)( -fa ).value(), mpz_class( ( p - a % p ) % p ).get_str() );
+        ASSERT_EQ( (string)( fa / fb * fb ).value(), mpz_class( a % p ).get_str() );
+        mpz_class r;
+        mpz_powm( r.get_mpz_t(), a.get_mpz_t(), e.get_mpz_t(), p.get_mpz_t() );
+        ASSERT_EQ( (string)fa.pow( UnsignedLargeInteger<256>( e.get_str() ) ).value(), r.get_str() );
+        
+        a = rnd.get_z_bits( 128 );
+        b = rnd.get_z_bits( 128 );
+        Fq qa( UnsignedLargeInteger<128>( a.get_str() ) ), qb( UnsignedLargeInteger<128>( b.get_str() ) );
+        ASSERT_EQ( (string)( qa * qb ).value(), mpz_class( a * b % q ).get_str() );
+        ASSERT_EQ( (string)( qa + qb ).value(), mpz_class( ( a + b ) % q ).get_str() );
+        qa *= qb;
+        qa -= qb;
+        ASSERT_EQ( (string)qa.value(), mpz_class( ( a * b - b % q + q * q ) % q ).get_str() );
+        
+        a = rnd.get_z_bits( 256 );
+        b = rnd.get_z_bits( 256 );
+        Fs sa( UnsignedLargeInteger<256>( a.get_str() ) ), sb( UnsignedLargeInteger<256>( b.get_str() ) );
+        ASSERT_EQ( (string)( sa * sb ).value(), mpz_class( a * b % s ).get_str() );
+        ASSERT_EQ( (string)( sa + sb ).value(), mpz_class( ( a + b ) % s ).get_str() );
+        ASSERT_EQ( (string)( sa - sb ).value(), mpz_class( ( a - b + 2 * s ) % s ).get_str() );
+        ASSERT_EQ( (string)( sa / sb * sb ).value(), mpz_class( a % s ).get_str() );
+     }
+   
+   ASSERT_EQ( (string)Fp( -7 ).value(), mpz_class( p - 7 ).get_str() );
+   ASSERT_EQ( Fp( -7 ), Fp( LargeInteger<256>( -7 ) ) );
+   ASSERT_EQ( Fp( 2 ).pow( modInt25519 - 2 ) * 4, Fp( 2 ) );
+   ASSERT_EQ( Fp( 3 ).pow( LargeInteger<256>( -2 ) ) * 9, Fp( 1 ) );
+   ASSERT_THROW( Fp( 5 ) / Fp( 0 ), not_invertible_error );
+   ASSERT_THROW( Fp( 1 ) / Fp( LargeInteger<256>( "-" + (string)modInt25519 ) ), not_invertible_error );
+   ASSERT_EQ( (string)Fs( -7 ).value(), mpz_class( s - 7 ).get_str() );
+   ASSERT_EQ( (string)Fs( LargeInteger<256>( INT64_MIN ) << 192 ).value(), mpz_class( s - ( mpz_class( 1 ) << 255 ) ).get_str() );
+}
+#endif
+
+TEST(LargeIntegerTest, Dynamic)
+{
+   typedef DynamicLargeInteger<2> D;
+   gmp_randclass rnd( gmp_randinit_default );
+   rnd.seed( 49 );
+   for( int k = 0; k < 200; ++k )
+     {
+        int bits = k < 100 ? 1 + k * 3 : 200 * k;
+        mpz_class agmp = rnd.get_z_bits( bits ), bgmp = rnd.get_z_bits( 1 + mpz_class( rnd.get_z_range( bits ) ).get_ui() );
+        if( k & 1 ) agmp = -agmp;
+        if( k & 2 ) bgmp = -bgmp;
+        D a( agmp.get_str() ), b( bgmp.get_str() );
+        ASSERT_EQ( (string)a, agmp.get_str() );
+        ASSERT_EQ( a.bitLength(), agmp == 0 ? 0 : (int)mpz_sizeinbase( agmp.get_mpz_t(), 2 ) );
+        ASSERT_EQ( (string)( a + b ), mpz_class( agmp + bgmp ).get_str() );
+        ASSERT_EQ( (string)( a - b ), mpz_class( agmp - bgmp ).get_str() );
+        ASSERT_EQ( (string)( b - a ), mpz_class( bgmp - agmp ).get_str() );
+        ASSERT_EQ( (string)( a * b ), mpz_class( agmp * bgmp ).get_str() );
+        if( bgmp != 0 )
+          {
+             ASSERT_EQ( (string)( a / b ), mpz_class( agmp / bgmp ).get_str() );
+             ASSERT_EQ( (string)( a % b ), mpz_class( agmp % bgmp ).get_str() );
+          }
+        ASSERT_EQ( (string)( a << ( k % 150 ) ), mpz_class( agmp << ( k % 150 ) ).get_str() );
+        mpz_class shifted;
+        mpz_fdiv_q_2exp( shifted.get_mpz_t(), agmp.get_mpz_t(), k % 150 );
+        ASSERT_EQ( (string)( a >> ( k % 150 ) ), shifted.get_str() );
+        ASSERT_EQ( a.compare( b ), agmp < bgmp ? -1 : agmp > bgmp ? 1 : 0 );
+        ASSERT_EQ( a < b, agmp < bgmp );
+        ASSERT_EQ( a == D( (string)a ), true );
+
+        LargeInteger<512> wrapped = a.toInteger<512>();
+        mpz_class modulus = mpz_class( 1 ) << 512;
+        mpz_class r = agmp % modulus;
+        if( r < 0 ) r += modulus;
+        if( r >= ( modulus >> 1 ) ) r -= modulus;
+        ASSERT_EQ( (string)wrapped, r.get_str() );
+        ASSERT_EQ( (string)D( wrapped ), r.get_str() );
+     }
+
+   D x( 42 ), y( -7 ), z;
+   ASSERT_EQ( x.significantLimbs(), 1 );
+   ASSERT_EQ( z.significantLimbs(), 0 );
+   ASSERT_EQ( (string)z, "0" );
+   ASSERT_EQ( x / y, D( -6 ) );
+   ASSERT_EQ( x % y, D( 0 ) );
+   ASSERT_EQ( ( x + 1 ) % y, D( 1 ) );
+   ASSERT_EQ( y >> 1, D( -4 ) );
+   ASSERT_EQ( y >> 100, D( -1 ) );
+   ASSERT_EQ( -( y + 7 ), z );
+   ASSERT_FALSE( ( -z ).isNegative() );
+   ASSERT_EQ( D( "0x1234567890abcdef1234567890ABCDEF" ).toHexString(), "1234567890abcdef1234567890abcdef" );
+   ASSERT_EQ( D( "0777" ), D( 511 ) );
+   ASSERT_THROW( D( "12a" ), number_format_error );
+   ASSERT_THROW( x / z, std::invalid_argument );
+
+   x = D( 1 ) << 1000;
+   x += x;
+   x *= x;
+   ASSERT_EQ( x, D( 1 ) << 2002 );
+   D q = x / y;
+   D::divRem( x, y, x, y );
+   ASSERT_EQ( x, q );
+   ASSERT_EQ( y, D( 2 ) );
+   D w( std::move( x ) );
+   ASSERT_EQ( x.significantLimbs(), 0 );
+   ASSERT_EQ( w.bitLength(), 2000 );
+   ASSERT_EQ( D( LargeInteger<256>( -1 ) ), D( -1 ) );
+   ASSERT_EQ( D( UnsignedLargeInteger<128>( -1 ) ), ( D( 1 ) << 128 ) - 1 );
+   ASSERT_EQ( ( UnsignedLargeInteger<64>( 0 ) - 3 ), ( D( -3 ).toInteger< 64, uint128_t, false >() ) );
+
+   std::stringstream ss;
+   ss << D( -255 ) << " " << std::hex << D( 255 );
+   ASSERT_EQ( ss.str(), "-255 ff" );
+}
+
+struct CountingAllocator
+{
+   typedef uint64_t value_type;
+
+   CountingAllocator( int& count ) : count( &count )
+     {
+     }
+
+   uint64_t* allocate( size_t n )
+     {
+        ++*count;
+        return new uint64_t[ n ];
+     }
+
+   void deallocate( uint64_t* p, size_t )
+     {
+        --*count;
+        delete[] p;
+     }
+
+   bool operator==( const CountingAllocator& a ) const
+     {
+        return count == a.count;
+     }
+
+   bool operator!=( const CountingAllocator& a ) const
+     {
+        return count != a.count;
+     }
+
+   int* count;
+};
+
+TEST(LargeIntegerTest, DynamicAllocators)
+{
+   DynamicLargeInteger<> f( 1 );
+   for( int i = 2; i <= 300; ++i ) f *= i;
+
+   LimbArena arena( 16 );
+   {
+      typedef DynamicLargeInteger< 2, ArenaAllocator > A;
+      A g( 1, arena );
+      for( int i = 2; i <= 300; ++i ) g *= i;
+      ASSERT_EQ( (string)g, (string)f );
+      ASSERT_TRUE( ( g / 7 ).getAllocator() == ArenaAllocator( arena ) );
+      ASSERT_EQ( (string)( g % ( g / 1000 - 1 ) ), (string)( f % ( f / 1000 - 1 ) ) );
+      ASSERT_EQ( (string)( g + 1 - (uint64_t)-1 ), (string)( f + 1 - DynamicLargeInteger<>( (uint64_t)-1 ) ) );
+      A h( g );
+      h += -5;
+      h -= 3u;
+      h /= 9;
+      h %= (int64_t)1000000007;
+      ASSERT_EQ( (string)h, (string)( ( f - 8 ) / 9 % 1000000007 ) );
+      ASSERT_TRUE( g > 0 && g != 1 && !( g <= -1 ) && A( 3, arena ) == 3 && A( -3, arena ) < 2 && A( 3, arena ) >= 3 );
+      ASSERT_EQ( (string)( ( g << 70 ) >> 3 ), (string)( ( f << 70 ) >> 3 ) );
+   }
+   arena.release();
+
+   int first = 0, second = 0;
+   {
+      typedef DynamicLargeInteger< 2, CountingAllocator > C;
+      C a( "0x" + f.toHexString(), first ), b( "-1234567890123456789012345678901234567890123456789", second );
+      C q = C( CountingAllocator( first ) ), r = C( CountingAllocator( first ) );
+      ASSERT_EQ( first, 1 );
+      C::divRem( a, b, q, r );
+      ASSERT_EQ( (string)q, (string)( f / DynamicLargeInteger<>( "-1234567890123456789012345678901234567890123456789" ) ) );
+      ASSERT_EQ( second, 1 );
+      ASSERT_TRUE( ( b * a ).getAllocator() == CountingAllocator( second ) );
+      C c( b );
+      ASSERT_EQ( second, 2 );
+      c = std::move( a );
+      ASSERT_TRUE( c.getAllocator() == CountingAllocator( second ) );
+      ASSERT_EQ( (string)c, (string)f );
+   }
+   ASSERT_EQ( first, 0 );
+   ASSERT_EQ( second, 0 );
+
+#ifdef MULTIINT_HAS_PMR
+   std::pmr::monotonic_buffer_resource resource;
+   PmrDynamicLargeInteger<> h( 1, &resource );
+   for( int i = 2; i <= 300; ++i ) h *= PmrDynamicLargeInteger<>( i, &resource );
+   ASSERT_EQ( (string)h, (string)f );
+   ASSERT_TRUE( ( h - 1 ).getAllocator().resource() == &resource );
+#endif
+}
+
+TEST(LargeIntegerTest, Unsigned)
+{
+   mpz_class modulus = mpz_class( 1 ) << 256;
+   string s1 = "0xfedcba9876543210fedcba9876543210fedcba9876543210fedcba9876543210";
+   string s2 = "0x8000000000000000000000000000000000000000000000000000000000000001";
+   string s3 = "2324562324354654768987455344234356324354656757858568764654657";
+   UnsignedLargeInteger<256> i1 = s1;
+   UnsignedLargeInteger<256> i2 = s2;
+   UnsignedLargeInteger<256> i3 = s3;
+   mpz_class i1gmp( s1 );
+   mpz_class i2gmp( s2 );
+   mpz_class i3gmp( s3 );
+   
+   ASSERT_FALSE( i1.isNegative() );
+   ASSERT_EQ( (string)i1, i1gmp.get_str() );
+   ASSERT_EQ( (string)( i1 + i2 ), mpz_class( ( i1gmp + i2gmp ) % modulus ).get_str() );
+   ASSERT_EQ( (string)( i3 - i1 ), mpz_class( ( i3gmp - i1gmp + modulus ) % modulus ).get_str() );
+   ASSERT_EQ( (string)( i1 * i2 ), mpz_class( ( i1gmp * i2gmp ) % modulus ).get_str() );
+   ASSERT_EQ( (string)( i1 * 4354657576 ), mpz_class( ( i1gmp * 4354657576 ) % modulus ).get_str() );
+   ASSERT_EQ( (string)( i1 / i3 ), mpz_class( i1gmp / i3gmp ).get_str() );
+   ASSERT_EQ( (string)( i1 % i3 ), mpz_class( i1gmp % i3gmp ).get_str() );
+   ASSERT_EQ( (string)( i1 / i2 ), mpz_class( i1gmp / i2gmp ).get_str() );
+   ASSERT_EQ( (string)( i2 / 4354657576 ), mpz_class( i2gmp / 4354657576 ).get_str() );
+   ASSERT_EQ( i2 % 4354657576, mpz_class( i2gmp % 4354657576 ).get_ui() );
+   ASSERT_EQ( (string)( i1 / -1 ), "0" );
+   ASSERT_EQ( (string)( i1 >> 100 ), mpz_class( i1gmp >> 100 ).get_str() );
+   ASSERT_EQ( (string)( i1 >> 3 ), mpz_class( i1gmp >> 3 ).get_str() );
+   ASSERT_TRUE( i1 > i3 );
+   ASSERT_TRUE( i2 > i3 );
+   ASSERT_TRUE( i3 < i2 );
+   ASSERT_EQ( (string)UnsignedLargeInteger<256>( -1 ), mpz_class( modulus - 1 ).get_str() );
+}